@@ -29,6 +29,13 @@
 	#pragma comment(lib, "shlwapi.lib")
 #else
 	#include <time.h>
+	#include <limits.h>
+	#include <wchar.h>
+	#include <sys/types.h>
+	#include <sys/stat.h>
+	#include <string>
+	#include <algorithm>
+	#include <cctype>
 #endif
 #include <math.h>
 #include "common.h"
@@ -356,7 +363,7 @@ int DLL_PREFIX my_swprintf_s(wchar_t *buffer, size_t sizeOfBuffer, const wchar_t
 {
 	va_list ap;
 	va_start(ap, format);
-	int result = vswprintf(buffer, format, ap);
+	int result = vswprintf(buffer, sizeOfBuffer, format, ap);
 	va_end(ap);
 	return result;
 }
@@ -1017,7 +1024,7 @@ const _TCHAR *DLL_PREFIX get_application_path()
 		} else {
 			my_tcscpy_s(app_path, _MAX_PATH, _T(".\\"));
 		}
-#else
+#elif defined(_USE_QT)
 #if defined(Q_OS_WIN)
 		std::string delim = "\\";
 #else
@@ -1029,6 +1036,9 @@ const _TCHAR *DLL_PREFIX get_application_path()
 		std::string cpath = csppath + my_procname + delim;
 		_my_mkdir(cpath);
 		strncpy(app_path, cpath.c_str(), _MAX_PATH - 1);
+#else
+		// rom images and config files are in the current directory
+		my_tcscpy_s(app_path, _MAX_PATH, get_initial_current_path());
 #endif
 		initialized = true;
 	}
@@ -107,7 +107,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <io.h>
+#ifdef _WIN32
+	#include <io.h>
+#else
+	#include <unistd.h>
+#endif
 #include <math.h>
 #if defined(_MSC_VER) && (_MSC_VER < 1920)
 	#include <typeinfo.h>
@@ -807,7 +811,7 @@ int16_t DLL_PREFIX ExchangeEndianS16(uint16_t x);
 		#define _fgetts fgets
 	#endif
 	#ifndef _ftprintf
-		#define _ftprintf printf
+		#define _ftprintf fprintf
 	#endif
 	#ifndef _tfopen
 		#define _tfopen fopen
@@ -836,6 +840,12 @@ int16_t DLL_PREFIX ExchangeEndianS16(uint16_t x);
 	#ifndef _tcsncicmp
 		#define _tcsncicmp strnicmp
 	#endif
+	#ifndef _tcsnicmp
+		#define _tcsnicmp strnicmp
+	#endif
+	#ifndef _tcsncmp
+		#define _tcsncmp strncmp
+	#endif
 	#ifndef _tcschr
 		#define _tcschr strchr
 	#endif
@@ -889,6 +899,10 @@ int16_t DLL_PREFIX ExchangeEndianS16(uint16_t x);
 	errno_t DLL_PREFIX my_tcsncpy_s(_TCHAR *strDestination, size_t numberOfElements, const _TCHAR *strSource, size_t count);
 	char * DLL_PREFIX my_strtok_s(char *strToken, const char *strDelimit, char **context);
 	_TCHAR *DLL_PREFIX my_tcstok_s(_TCHAR *strToken, const char *strDelimit, _TCHAR **context);
+	template <size_t size> errno_t my_tcscpy_s(_TCHAR (&strDestination)[size], const _TCHAR *strSource)
+	{
+		return my_tcscpy_s(strDestination, size, strSource);
+	}
 	#define my_fprintf_s fprintf
 	#define my_ftprintf_s _ftprintf
 	int DLL_PREFIX my_sprintf_s(char *buffer, size_t sizeOfBuffer, const char *format, ...);
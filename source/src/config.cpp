@@ -95,12 +95,16 @@ void initialize_config()
 			config.direct_load_mzt[drv] = true;
 			config.baud_high[drv] = true;
 		}
+		config.tape_turbo = false;
 	#endif
 	#if defined(USE_ROMDISK)
 		config.ipl_storage = 0;
 	#endif
 	#if defined(USE_COLOR_BLENDER)
 		config.color_blender = false;
+	#endif
+	#if defined(USE_ACCURATE_RASTER)
+		config.accurate_raster = false;
 	#endif
 		config.compress_state = true;
 	
@@ -117,6 +121,9 @@ void initialize_config()
 	#endif
 	config.sound_latency = 1;	// 100msec
 	config.sound_strict_rendering = true;
+	#ifdef USE_BAND_LIMITED_SOUND
+		config.sound_band_limited = false;
+	#endif
 	#ifdef USE_FLOPPY_DISK
 		config.sound_noise_fdd = true;
 	#endif
@@ -213,12 +220,16 @@ void load_config(const _TCHAR* config_path)
 			config.direct_load_mzt[drv] = MyGetPrivateProfileBool(_T("Control"), create_string(_T("DirectLoadMZT%d"), drv + 1), config.direct_load_mzt[drv], config_path);
 			config.baud_high[drv] = MyGetPrivateProfileBool(_T("Control"), create_string(_T("BaudHigh%d"), drv + 1), config.baud_high[drv], config_path);
 		}
+		config.tape_turbo = MyGetPrivateProfileBool(_T("Control"), _T("TapeTurbo"), config.tape_turbo, config_path);
 	#endif
 	#ifdef USE_ROMDISK
 		config.ipl_storage = MyGetPrivateProfileInt(_T("ROMDisk"), _T("StorageID"), config.ipl_storage, config_path);
 	#endif
 	#ifdef USE_COLOR_BLENDER
 		config.color_blender = MyGetPrivateProfileInt(_T("Control"), _T("ColorBlender"), config.color_blender, config_path);
+	#endif
+	#ifdef USE_ACCURATE_RASTER
+		config.accurate_raster = MyGetPrivateProfileBool(_T("Control"), _T("AccurateRaster"), config.accurate_raster, config_path);
 	#endif
 		config.compress_state = MyGetPrivateProfileBool(_T("Control"), _T("CompressState"), config.compress_state, config_path);
 	
@@ -316,6 +327,9 @@ void load_config(const _TCHAR* config_path)
 	config.sound_frequency = MyGetPrivateProfileInt(_T("Sound"), _T("Frequency"), config.sound_frequency, config_path);
 	config.sound_latency = MyGetPrivateProfileInt(_T("Sound"), _T("Latency"), config.sound_latency, config_path);
 	config.sound_strict_rendering = MyGetPrivateProfileBool(_T("Sound"), _T("StrictRendering"), config.sound_strict_rendering, config_path);
+	#ifdef USE_BAND_LIMITED_SOUND
+		config.sound_band_limited = MyGetPrivateProfileBool(_T("Sound"), _T("BandLimited"), config.sound_band_limited, config_path);
+	#endif
 	#ifdef USE_FLOPPY_DISK
 		config.sound_noise_fdd = MyGetPrivateProfileBool(_T("Sound"), _T("NoiseFDD"), config.sound_noise_fdd, config_path);;
 	#endif
@@ -454,12 +468,16 @@ void save_config(const _TCHAR* config_path)
 			MyWritePrivateProfileBool(_T("Control"), create_string(_T("DirectLoadMZT%d"), drv + 1), config.direct_load_mzt[drv], config_path);
 			MyWritePrivateProfileBool(_T("Control"), create_string(_T("BaudHigh%d"), drv + 1), config.baud_high[drv], config_path);
 		}
+		MyWritePrivateProfileBool(_T("Control"), _T("TapeTurbo"), config.tape_turbo, config_path);
 	#endif
 	#ifdef USE_ROMDISK
 		MyWritePrivateProfileInt(_T("ROMDisk"), _T("StorageID"), config.ipl_storage, config_path);
 	#endif
 	#ifdef USE_COLOR_BLENDER
 		MyWritePrivateProfileBool(_T("Control"), _T("ColorBlender"), config.color_blender, config_path);
+	#endif
+	#ifdef USE_ACCURATE_RASTER
+		MyWritePrivateProfileBool(_T("Control"), _T("AccurateRaster"), config.accurate_raster, config_path);
 	#endif
 		MyWritePrivateProfileBool(_T("Control"), _T("CompressState"), config.compress_state, config_path);
 	
@@ -557,6 +575,9 @@ void save_config(const _TCHAR* config_path)
 	MyWritePrivateProfileInt(_T("Sound"), _T("Frequency"), config.sound_frequency, config_path);
 	MyWritePrivateProfileInt(_T("Sound"), _T("Latency"), config.sound_latency, config_path);
 	MyWritePrivateProfileBool(_T("Sound"), _T("StrictRendering"), config.sound_strict_rendering, config_path);
+	#ifdef USE_BAND_LIMITED_SOUND
+		MyWritePrivateProfileBool(_T("Sound"), _T("BandLimited"), config.sound_band_limited, config_path);
+	#endif
 	#ifdef USE_FLOPPY_DISK
 		MyWritePrivateProfileBool(_T("Sound"), _T("NoiseFDD"), config.sound_noise_fdd, config_path);
 	#endif
@@ -106,6 +106,9 @@ typedef struct {
 	#if defined(USE_SHARED_DLL) || defined(USE_COLOR_BLENDER)
 		bool color_blender;
 	#endif
+	#if defined(USE_SHARED_DLL) || defined(USE_ACCURATE_RASTER)
+		bool accurate_raster;
+	#endif
 #if defined(USE_SHARED_DLL) || defined(USE_PRINTER_TYPE)
 		int printer_type;
 	#endif
@@ -117,6 +120,7 @@ typedef struct {
 		bool wave_shaper[USE_TAPE_TMP];
 		bool direct_load_mzt[USE_TAPE_TMP];
 		bool baud_high[USE_TAPE_TMP];
+		bool tape_turbo;
 	#endif
 	bool compress_state;
 	int cpu_power;
@@ -178,6 +182,9 @@ typedef struct {
 	int sound_frequency;
 	int sound_latency;
 	bool sound_strict_rendering;
+	#if defined(USE_SHARED_DLL) || defined(USE_BAND_LIMITED_SOUND)
+		bool sound_band_limited;
+	#endif
 	#if defined(USE_SHARED_DLL) || defined(USE_FLOPPY_DISK)
 		bool sound_noise_fdd;
 	#endif
@@ -8,7 +8,9 @@
 */
 
 #include <stdlib.h>
+#ifdef _WIN32
 #include <io.h>
+#endif
 #include <fcntl.h>
 #include "vm/device.h"
 #include "vm/debugger.h"
@@ -153,6 +155,254 @@ break_point_t *get_break_point(DEBUGGER *debugger, const _TCHAR *command)
 	return NULL;
 }
 
+// condition of breakpoint
+typedef struct {
+	DEVICE *device;
+	const _TCHAR *ptr;
+	break_cond_t *cond;
+	int depth;
+	const _TCHAR *error;
+} break_cond_parser_t;
+
+static const struct {
+	const _TCHAR *name;
+	int level, code;
+} break_cond_ops[] = {
+	{_T("||"), 0, BREAK_COND_LOR},
+	{_T("&&"), 1, BREAK_COND_LAND},
+	{_T("|"),  2, BREAK_COND_OR},
+	{_T("^"),  3, BREAK_COND_XOR},
+	{_T("&"),  4, BREAK_COND_AND},
+	{_T("=="), 5, BREAK_COND_EQ},
+	{_T("!="), 5, BREAK_COND_NE},
+	{_T("<<"), 7, BREAK_COND_SHL},
+	{_T(">>"), 7, BREAK_COND_SHR},
+	{_T("<="), 6, BREAK_COND_LE},
+	{_T(">="), 6, BREAK_COND_GE},
+	{_T("<"),  6, BREAK_COND_LT},
+	{_T(">"),  6, BREAK_COND_GT},
+	{_T("+"),  8, BREAK_COND_ADD},
+	{_T("-"),  8, BREAK_COND_SUB},
+	{_T("*"),  9, BREAK_COND_MUL},
+	{_T("/"),  9, BREAK_COND_DIV},
+	{_T("%"),  9, BREAK_COND_MOD},
+	{NULL, 0, 0}
+};
+
+static void skip_cond_spaces(break_cond_parser_t *p)
+{
+	while(*p->ptr == _T(' ') || *p->ptr == _T('\t')) {
+		p->ptr++;
+	}
+}
+
+static bool is_cond_name_char(_TCHAR c, bool first)
+{
+	if((c >= _T('A') && c <= _T('Z')) || (c >= _T('a') && c <= _T('z')) || c == _T('_') || c == _T('.') || c == _T('@') || c == _T('?')) {
+		return true;
+	}
+	return !first && ((c >= _T('0') && c <= _T('9')) || c == _T('\''));
+}
+
+static bool emit_cond_code(break_cond_parser_t *p, uint32_t code, int stack)
+{
+	if(p->cond->length >= MAX_BREAK_COND_CODE) {
+		p->error = _T("condition is too long");
+		return false;
+	}
+	p->cond->code[p->cond->length++] = code;
+	if((p->depth += stack) > MAX_BREAK_COND_STACK) {
+		p->error = _T("condition is too complex");
+		return false;
+	}
+	return true;
+}
+
+static bool parse_cond_expr(break_cond_parser_t *p, int level);
+
+static bool parse_cond_unary(break_cond_parser_t *p)
+{
+	skip_cond_spaces(p);
+	_TCHAR c = *p->ptr;
+	
+	if(c == _T('!') || c == _T('~') || c == _T('-') || c == _T('+')) {
+		p->ptr++;
+		if(!parse_cond_unary(p)) {
+			return false;
+		}
+		if(c == _T('!')) {
+			return emit_cond_code(p, BREAK_COND_LNOT, 0);
+		} else if(c == _T('~')) {
+			return emit_cond_code(p, BREAK_COND_NOT, 0);
+		} else if(c == _T('-')) {
+			return emit_cond_code(p, BREAK_COND_NEG, 0);
+		}
+		return true;
+	} else if(c == _T('(') || c == _T('[') || c == _T('{')) {
+		_TCHAR close = (c == _T('(')) ? _T(')') : (c == _T('[')) ? _T(']') : _T('}');
+		p->ptr++;
+		if(!parse_cond_expr(p, 0)) {
+			return false;
+		}
+		skip_cond_spaces(p);
+		if(*p->ptr != close) {
+			p->error = _T("unbalanced parenthesis");
+			return false;
+		}
+		p->ptr++;
+		if(c == _T('[')) {
+			return emit_cond_code(p, BREAK_COND_MEM8, 0);
+		} else if(c == _T('{')) {
+			return emit_cond_code(p, BREAK_COND_MEM16, 0);
+		}
+		return true;
+	} else if(c >= _T('0') && c <= _T('9')) {
+		// hexa, the value must start with a digit
+		_TCHAR *end;
+		uint32_t value = _tcstoul(p->ptr, &end, 16);
+		p->ptr = end;
+		if(*p->ptr == _T('H') || *p->ptr == _T('h')) {
+			p->ptr++;
+		}
+		return emit_cond_code(p, BREAK_COND_NUM, 1) && emit_cond_code(p, value, 0);
+	} else if(c == _T('%') && p->ptr[1] >= _T('0') && p->ptr[1] <= _T('9')) {
+		// decimal
+		_TCHAR *end;
+		uint32_t value = _tcstoul(p->ptr + 1, &end, 10);
+		p->ptr = end;
+		return emit_cond_code(p, BREAK_COND_NUM, 1) && emit_cond_code(p, value, 0);
+	} else if(c == _T('\'') && p->ptr[1] != _T('\0') && p->ptr[2] == _T('\'')) {
+		// ank
+		uint32_t value = p->ptr[1] & 0xff;
+		p->ptr += 3;
+		return emit_cond_code(p, BREAK_COND_NUM, 1) && emit_cond_code(p, value, 0);
+	} else if(is_cond_name_char(c, true)) {
+		// symbol or register
+		const _TCHAR *name = p->ptr;
+		int len = 0;
+		while(is_cond_name_char(name[len], len == 0)) {
+			len++;
+		}
+		p->ptr += len;
+		
+		DEBUGGER *debugger = (DEBUGGER *)p->device->get_debugger();
+		if(debugger != NULL) {
+			for(symbol_t* symbol = debugger->first_symbol; symbol; symbol = symbol->next_symbol) {
+				if(_tcsnicmp(symbol->name, name, len) == 0 && symbol->name[len] == _T('\0')) {
+					return emit_cond_code(p, BREAK_COND_NUM, 1) && emit_cond_code(p, symbol->addr, 0);
+				}
+			}
+		}
+		_TCHAR reg[array_length(p->cond->regs[0])];
+		if(len >= (int)array_length(reg)) {
+			p->error = _T("unknown symbol or register");
+			return false;
+		}
+		memcpy(reg, name, sizeof(_TCHAR) * len);
+		reg[len] = _T('\0');
+		if(!p->device->is_debug_reg(reg)) {
+			p->error = _T("unknown symbol or register");
+			return false;
+		}
+		int index;
+		for(index = 0; index < MAX_BREAK_COND_REGS && p->cond->regs[index][0] != _T('\0'); index++) {
+			if(_tcsnicmp(p->cond->regs[index], name, len) == 0 && p->cond->regs[index][len] == _T('\0')) {
+				break;
+			}
+		}
+		if(index == MAX_BREAK_COND_REGS) {
+			p->error = _T("too many registers in condition");
+			return false;
+		}
+		memcpy(p->cond->regs[index], name, sizeof(_TCHAR) * len);
+		p->cond->regs[index][len] = _T('\0');
+		return emit_cond_code(p, BREAK_COND_REG, 1) && emit_cond_code(p, index, 0);
+	}
+	p->error = (c == _T('\0')) ? _T("unexpected end of condition") : _T("syntax error in condition");
+	return false;
+}
+
+static bool parse_cond_expr(break_cond_parser_t *p, int level)
+{
+	if(level > 9) {
+		return parse_cond_unary(p);
+	}
+	if(!parse_cond_expr(p, level + 1)) {
+		return false;
+	}
+	while(true) {
+		skip_cond_spaces(p);
+		int op = -1;
+		for(int i = 0; break_cond_ops[i].name != NULL; i++) {
+			int len = (int)_tcslen(break_cond_ops[i].name);
+			if(_tcsncmp(p->ptr, break_cond_ops[i].name, len) == 0) {
+				// don't take the first character of "||", "&&", "<<" and so on
+				if(break_cond_ops[i].level == level) {
+					op = i;
+				}
+				break;
+			}
+		}
+		if(op == -1) {
+			return true;
+		}
+		p->ptr += _tcslen(break_cond_ops[op].name);
+		if(!parse_cond_expr(p, level + 1)) {
+			return false;
+		}
+		if(!emit_cond_code(p, break_cond_ops[op].code, -1)) {
+			return false;
+		}
+	}
+}
+
+break_cond_t *compile_break_cond(DEVICE *device, const _TCHAR *text, const _TCHAR **error)
+{
+	break_cond_parser_t parser;
+	parser.device = device;
+	parser.ptr = text;
+	parser.cond = (break_cond_t *)calloc(sizeof(break_cond_t), 1);
+	parser.depth = 0;
+	parser.error = NULL;
+	
+	if(parse_cond_expr(&parser, 0)) {
+		skip_cond_spaces(&parser);
+		if(*parser.ptr == _T('\0')) {
+			my_tcscpy_s(parser.cond->text, array_length(parser.cond->text), text);
+			return parser.cond;
+		}
+		parser.error = _T("syntax error in condition");
+	}
+	free(parser.cond);
+	*error = parser.error;
+	return NULL;
+}
+
+// split "<params> IF <condition>" and compile the condition
+bool get_break_cond(OSD *osd, DEVICE *target, _TCHAR **params, int *num, break_cond_t **cond)
+{
+	*cond = NULL;
+	for(int i = 1; i < *num; i++) {
+		if(_tcsicmp(params[i], _T("IF")) == 0) {
+			_TCHAR text[MAX_COMMAND_LENGTH + 1] = {0};
+			for(int j = i + 1; j < *num; j++) {
+				if(j > i + 1) {
+					my_tcscat_s(text, array_length(text), _T(" "));
+				}
+				my_tcscat_s(text, array_length(text), params[j]);
+			}
+			const _TCHAR *error = NULL;
+			if((*cond = compile_break_cond(target, text, &error)) == NULL) {
+				my_printf(osd, _T("%s\n"), error);
+				return false;
+			}
+			*num = i;
+			break;
+		}
+	}
+	return true;
+}
+
 void show_break_reason(OSD *osd, DEVICE *cpu, DEVICE *target, bool hide_bp)
 {
 	DEBUGGER *cpu_debugger = (DEBUGGER *)cpu->get_debugger();
@@ -646,6 +896,56 @@ void* debugger_thread(void *lpx)
 				} else {
 					my_printf(p->osd, _T("invalid parameter number\n"));
 				}
+			} else if(_tcsicmp(params[0], _T("UTW")) == 0) {
+				if(num == 1) {
+					if(!target->save_debug_trace(cpu_debugger->file_path)) {
+						my_printf(p->osd, _T("can't write execution trace to %s\n"), cpu_debugger->file_path);
+					}
+				} else {
+					my_printf(p->osd, _T("invalid parameter number\n"));
+				}
+			} else if(_tcsicmp(params[0], _T("UTD")) == 0) {
+				if(num == 1) {
+					_TCHAR text_path[_MAX_PATH];
+					my_stprintf_s(text_path, _MAX_PATH, _T("%s.txt"), cpu_debugger->file_path);
+					if(!target->decode_debug_trace(cpu_debugger->file_path, text_path)) {
+						my_printf(p->osd, _T("can't decode execution trace in %s\n"), cpu_debugger->file_path);
+					}
+				} else {
+					my_printf(p->osd, _T("invalid parameter number\n"));
+				}
+			} else if(_tcsicmp(params[0], _T("PFW")) == 0) {
+				if(num == 1) {
+					_TCHAR stack_path[_MAX_PATH];
+					my_stprintf_s(stack_path, _MAX_PATH, _T("%s.folded"), cpu_debugger->file_path);
+					if(!target->save_debug_profile(cpu_debugger->file_path, stack_path)) {
+						my_printf(p->osd, _T("can't write profile to %s\n"), cpu_debugger->file_path);
+					}
+				} else {
+					my_printf(p->osd, _T("invalid parameter number\n"));
+				}
+			} else if(_tcsicmp(params[0], _T("PFC")) == 0) {
+				if(num == 1) {
+					target->clear_debug_profile();
+				} else {
+					my_printf(p->osd, _T("invalid parameter number\n"));
+				}
+			} else if(_tcsicmp(params[0], _T("MHW")) == 0) {
+				if(num == 1) {
+					_TCHAR report_path[_MAX_PATH];
+					my_stprintf_s(report_path, _MAX_PATH, _T("%s.txt"), cpu_debugger->file_path);
+					if(!target->save_debug_heatmap(cpu_debugger->file_path, report_path)) {
+						my_printf(p->osd, _T("can't write memory access heatmap to %s\n"), cpu_debugger->file_path);
+					}
+				} else {
+					my_printf(p->osd, _T("invalid parameter number\n"));
+				}
+			} else if(_tcsicmp(params[0], _T("MHC")) == 0) {
+				if(num == 1) {
+					target->clear_debug_heatmap();
+				} else {
+					my_printf(p->osd, _T("invalid parameter number\n"));
+				}
 			} else if(_tcsicmp(params[0], _T("H")) == 0) {
 				if(num == 3) {
 					uint32_t l = my_hexatoi(target, params[1]);
@@ -817,22 +1117,16 @@ void* debugger_thread(void *lpx)
 					my_printf(p->osd, _T("debugger is not attached to target device %s\n"), target->this_device_name);
 				} else {
 					break_point_t *bp = get_break_point(target_debugger, params[0]);
-					if(num == 2) {
+					break_cond_t *cond = NULL;
+					if(!get_break_cond(p->osd, target, params, &num, &cond)) {
+						// error is already shown
+					} else if(num == 2) {
 						uint32_t addr = my_hexatoi(target, params[1]);
-						bool found = false;
-						for(int i = 0; i < MAX_BREAK_POINTS && !found; i++) {
-							if(bp->table[i].status == 0 || (bp->table[i].addr == addr && bp->table[i].mask == target->get_debug_prog_addr_mask())) {
-								bp->table[i].addr = addr;
-								bp->table[i].mask = target->get_debug_prog_addr_mask();
-								bp->table[i].status = 1;
-								bp->table[i].check_point = (params[0][0] == 'C' || params[0][0] == 'c' || params[0][1] == 'C' || params[0][1] == 'c');
-								found = true;
-							}
-						}
-						if(!found) {
-							my_printf(p->osd, _T("too many break points\n"));
-						}
+						target_debugger->add_break_point(bp, addr, target->get_debug_prog_addr_mask(), (params[0][0] == 'C' || params[0][0] == 'c' || params[0][1] == 'C' || params[0][1] == 'c'), cond);
 					} else {
+						if(cond != NULL) {
+							free(cond);
+						}
 						my_printf(p->osd, _T("invalid parameter number\n"));
 					}
 				}
@@ -842,22 +1136,16 @@ void* debugger_thread(void *lpx)
 					my_printf(p->osd, _T("debugger is not attached to target device %s\n"), target->this_device_name);
 				} else {
 					break_point_t *bp = get_break_point(target_debugger, params[0]);
-					if(num == 2) {
+					break_cond_t *cond = NULL;
+					if(!get_break_cond(p->osd, target, params, &num, &cond)) {
+						// error is already shown
+					} else if(num == 2) {
 						uint32_t addr = my_hexatoi(target, params[1]);
-						bool found = false;
-						for(int i = 0; i < MAX_BREAK_POINTS && !found; i++) {
-							if(bp->table[i].status == 0 || (bp->table[i].addr == addr && bp->table[i].mask == target->get_debug_data_addr_mask())) {
-								bp->table[i].addr = addr;
-								bp->table[i].mask = target->get_debug_data_addr_mask();
-								bp->table[i].status = 1;
-								bp->table[i].check_point = (params[0][0] == 'C' || params[0][0] == 'c' || params[0][1] == 'C' || params[0][1] == 'c');
-								found = true;
-							}
-						}
-						if(!found) {
-							my_printf(p->osd, _T("too many break points\n"));
-						}
+						target_debugger->add_break_point(bp, addr, target->get_debug_data_addr_mask(), (params[0][0] == 'C' || params[0][0] == 'c' || params[0][1] == 'C' || params[0][1] == 'c'), cond);
 					} else {
+						if(cond != NULL) {
+							free(cond);
+						}
 						my_printf(p->osd, _T("invalid parameter number\n"));
 					}
 				}
@@ -867,25 +1155,19 @@ void* debugger_thread(void *lpx)
 					my_printf(p->osd, _T("debugger is not attached to target device %s\n"), target->this_device_name);
 				} else {
 					break_point_t *bp = get_break_point(target_debugger, params[0]);
-					if(num == 2 || num == 3) {
+					break_cond_t *cond = NULL;
+					if(!get_break_cond(p->osd, target, params, &num, &cond)) {
+						// error is already shown
+					} else if(num == 2 || num == 3) {
 						uint32_t addr = my_hexatoi(target, params[1]), mask = 0xff;
 						if(num == 3) {
 							mask = my_hexatoi(target, params[2]);
 						}
-						bool found = false;
-						for(int i = 0; i < MAX_BREAK_POINTS && !found; i++) {
-							if(bp->table[i].status == 0 || (bp->table[i].addr == addr && bp->table[i].mask == mask)) {
-								bp->table[i].addr = addr;
-								bp->table[i].mask = mask;
-								bp->table[i].status = 1;
-								bp->table[i].check_point = (params[0][1] == 'C' || params[0][1] == 'c');
-								found = true;
-							}
-						}
-						if(!found) {
-							my_printf(p->osd, _T("too many break points\n"));
-						}
+						target_debugger->add_break_point(bp, addr, mask, (params[0][1] == 'C' || params[0][1] == 'c'), cond);
 					} else {
+						if(cond != NULL) {
+							free(cond);
+						}
 						my_printf(p->osd, _T("invalid parameter number\n"));
 					}
 				}
@@ -895,15 +1177,14 @@ void* debugger_thread(void *lpx)
 				} else {
 					break_point_t *bp = get_break_point(target_debugger, params[0]);
 					if(num == 2 && (_tcsicmp(params[1], _T("*")) == 0 || _tcsicmp(params[1], _T("ALL")) == 0)) {
-						memset(bp->table, 0, sizeof(bp->table));
+						target_debugger->clear_break_points(bp);
 					} else if(num >= 2) {
 						for(int i = 1; i < num; i++) {
 							int index = my_hexatoi(target, params[i]);
-							if(!(index >= 0 && index < MAX_BREAK_POINTS)) {
+							if(!(index >= 0 && index < bp->count)) {
 								my_printf(p->osd, _T("invalid index %x\n"), index);
 							} else {
-								bp->table[index].addr = bp->table[index].mask = 0;
-								bp->table[index].status = 0;
+								target_debugger->remove_break_point(bp, index);
 							}
 						}
 					} else {
@@ -918,15 +1199,16 @@ void* debugger_thread(void *lpx)
 					break_point_t *bp = get_break_point(target_debugger, params[0]);
 					bool enabled = (params[0][1] == _T('E') || params[0][1] == _T('e') || params[0][2] == _T('E') || params[0][2] == _T('e'));
 					if(num == 2 && (_tcsicmp(params[1], _T("*")) == 0 || _tcsicmp(params[1], _T("ALL")) == 0)) {
-						for(int i = 0; i < MAX_BREAK_POINTS; i++) {
+						for(int i = 0; i < bp->count; i++) {
 							if(bp->table[i].status != 0) {
 								bp->table[i].status = enabled ? 1 : -1;
 							}
 						}
+						target_debugger->update_break_points(bp);
 					} else if(num >= 2) {
 						for(int i = 1; i < num; i++) {
 							int index = my_hexatoi(target, params[i]);
-							if(!(index >= 0 && index < MAX_BREAK_POINTS)) {
+							if(!(index >= 0 && index < bp->count)) {
 								my_printf(p->osd, _T("invalid index %x\n"), index);
 							} else if(bp->table[index].status == 0) {
 								my_printf(p->osd, _T("break point %x is null\n"), index);
@@ -934,6 +1216,7 @@ void* debugger_thread(void *lpx)
 								bp->table[index].status = enabled ? 1 : -1;
 							}
 						}
+						target_debugger->update_break_points(bp);
 					} else {
 						my_printf(p->osd, _T("invalid parameter number\n"));
 					}
@@ -944,12 +1227,14 @@ void* debugger_thread(void *lpx)
 				} else {
 					if(num == 1) {
 						break_point_t *bp = get_break_point(target_debugger, params[0]);
-						for(int i = 0; i < MAX_BREAK_POINTS; i++) {
+						for(int i = 0; i < bp->count; i++) {
 							if(bp->table[i].status) {
-								my_printf(p->osd, _T("%x %c %s %s\n"), i,
+								my_printf(p->osd, _T("%x %c %s %s%s%s\n"), i,
 									bp->table[i].status == 1 ? _T('e') : _T('d'),
 									my_get_value_and_symbol(target, _T("%08X"), bp->table[i].addr),
-									bp->table[i].check_point ? "checkpoint" : "");
+									bp->table[i].check_point ? _T("checkpoint ") : _T(""),
+									bp->table[i].cond ? _T("if ") : _T(""),
+									bp->table[i].cond ? bp->table[i].cond->text : _T(""));
 							}
 						}
 					} else {
@@ -962,13 +1247,15 @@ void* debugger_thread(void *lpx)
 				} else {
 					if(num == 1) {
 						break_point_t *bp = get_break_point(target_debugger, params[0]);
-						for(int i = 0; i < MAX_BREAK_POINTS; i++) {
+						for(int i = 0; i < bp->count; i++) {
 							if(bp->table[i].status) {
-								my_printf(p->osd, _T("%x %c %s %08X %s\n"), i,
+								my_printf(p->osd, _T("%x %c %s %08X %s%s%s\n"), i,
 									bp->table[i].status == 1 ? _T('e') : _T('d'),
 									my_get_value_and_symbol(target, _T("%08X"), bp->table[i].addr),
 									bp->table[i].mask,
-									bp->table[i].check_point ? "checkpoint" : "");
+									bp->table[i].check_point ? _T("checkpoint ") : _T(""),
+									bp->table[i].cond ? _T("if ") : _T(""),
+									bp->table[i].cond ? bp->table[i].cond->text : _T(""));
 							}
 						}
 					} else {
@@ -980,17 +1267,11 @@ void* debugger_thread(void *lpx)
 					bool break_points_stored = false;
 					if(_tcsicmp(params[0], _T("P")) == 0) {
 						cpu_debugger->store_break_points();
-						cpu_debugger->bp.table[0].addr = (cpu->get_next_pc() + cpu->debug_dasm(cpu->get_next_pc(), buffer, array_length(buffer))) & cpu->get_debug_prog_addr_mask();
-						cpu_debugger->bp.table[0].mask = cpu->get_debug_prog_addr_mask();
-						cpu_debugger->bp.table[0].status = 1;
-						cpu_debugger->bp.table[0].check_point = false;
+						cpu_debugger->add_break_point(&cpu_debugger->bp, (cpu->get_next_pc() + cpu->debug_dasm(cpu->get_next_pc(), buffer, array_length(buffer))) & cpu->get_debug_prog_addr_mask(), cpu->get_debug_prog_addr_mask(), false, NULL);
 						break_points_stored = true;
 					} else if(num >= 2) {
 						cpu_debugger->store_break_points();
-						cpu_debugger->bp.table[0].addr = my_hexatoi(cpu, params[1]) & cpu->get_debug_prog_addr_mask();
-						cpu_debugger->bp.table[0].mask = cpu->get_debug_prog_addr_mask();
-						cpu_debugger->bp.table[0].status = 1;
-						cpu_debugger->bp.table[0].check_point = false;
+						cpu_debugger->add_break_point(&cpu_debugger->bp, my_hexatoi(cpu, params[1]) & cpu->get_debug_prog_addr_mask(), cpu->get_debug_prog_addr_mask(), false, NULL);
 						break_points_stored = true;
 					}
 RESTART_GO:
@@ -1011,6 +1292,11 @@ RESTART_GO:
 						}
 						p->osd->sleep(10);
 					}
+#elif defined(_USE_HEADLESS)
+					// the commands are read from the standard input, so go until breakpoint is hit
+					while(!p->request_terminate && !cpu_debugger->now_suspended) {
+						p->osd->sleep(10);
+					}
 #endif
 					// break cpu
 					cpu_debugger->now_going = false;
@@ -1306,6 +1592,12 @@ RESTART_GO:
 				my_printf(p->osd, _T("S <range> <list> - search\n"));
 				my_printf(p->osd, _T("U [<range>] - unassemble\n"));
 				my_printf(p->osd, _T("UT [<steps>] - unassemble trace\n"));
+				my_printf(p->osd, _T("UTW - write execution trace file\n"));
+				my_printf(p->osd, _T("UTD - decode execution trace file to text file\n"));
+				my_printf(p->osd, _T("PFW - write profile and collapsed stacks (.folded) file\n"));
+				my_printf(p->osd, _T("PFC - clear profile\n"));
+				my_printf(p->osd, _T("MHW - write memory access heatmap (bmp) and report (.txt) file\n"));
+				my_printf(p->osd, _T("MHC - clear memory access heatmap\n"));
 				
 				my_printf(p->osd, _T("H <value> <value> - hexadd\n"));
 				my_printf(p->osd, _T("N <filename> - name\n"));
@@ -1315,9 +1607,9 @@ RESTART_GO:
 				my_printf(p->osd, _T("SC - clear symbol(s)\n"));
 				my_printf(p->osd, _T("SL - list symbol(s)\n"));
 				
-				my_printf(p->osd, _T("BP <address> - set breakpoint\n"));
-				my_printf(p->osd, _T("{R,W}BP <address> - set breakpoint (break at memory access)\n"));
-				my_printf(p->osd, _T("{I,O}BP <port> [<mask>] - set breakpoint (break at i/o access)\n"));
+				my_printf(p->osd, _T("BP <address> [IF <condition>] - set breakpoint\n"));
+				my_printf(p->osd, _T("{R,W}BP <address> [IF <condition>] - set breakpoint (break at memory access)\n"));
+				my_printf(p->osd, _T("{I,O}BP <port> [<mask>] [IF <condition>] - set breakpoint (break at i/o access)\n"));
 				my_printf(p->osd, _T("[{R,W,I,O}]B{C,D,E} {*,<list>} - clear/disable/enable breakpoint(s)\n"));
 				my_printf(p->osd, _T("[{R,W,I,O}]BL - list breakpoints\n"));
 				my_printf(p->osd, _T("[{R,W,I,O}]CP <address/port> [<mask>] - set checkpoint (don't break)\n"));
@@ -1340,6 +1632,7 @@ RESTART_GO:
 				my_printf(p->osd, _T("!! <remark> - do nothing\n"));
 				
 				my_printf(p->osd, _T("<value> - hexa, decimal(%%d), ascii('a')\n"));
+				my_printf(p->osd, _T("<condition> - expression of C operators, registers, hexa starting with digit, [<byte>], {<word>}\n"));
 			} else {
 				my_printf(p->osd, _T("unknown command %s\n"), params[0]);
 			}
@@ -96,6 +96,9 @@ EMU::EMU()
 	osd->instance_handle = hinst;
 #endif
 	osd->initialize(sound_rate, sound_samples);
+#ifdef _TRACE_LOG
+	initialize_trace_log();
+#endif
 	
 	// initialize vm
 	osd->vm = vm = new VM(this);
@@ -138,6 +141,9 @@ EMU::~EMU()
 	release_debugger();
 #endif
 	delete vm;
+#ifdef _TRACE_LOG
+	release_trace_log();
+#endif
 	osd->release();
 	delete osd;
 #ifdef _DEBUG_LOG
@@ -194,6 +200,11 @@ bool EMU::is_frame_skippable()
 	return vm->is_frame_skippable();
 }
 
+void EMU::set_render_demand(bool value)
+{
+	vm->set_render_demand(value);
+}
+
 int EMU::run()
 {
 	if(now_suspended) {
@@ -1564,6 +1575,17 @@ bool EMU::is_sound_recording()
 	return osd->now_record_sound;
 }
 
+bool EMU::start_record_sound_stems(const _TCHAR* prefix)
+{
+	// each sound device is written to its own file by the thread of osd
+	return vm->start_record_sound_stems(osd->get_sound_writer(), prefix);
+}
+
+void EMU::stop_record_sound_stems()
+{
+	vm->stop_record_sound_stems();
+}
+
 // ----------------------------------------------------------------------------
 // video
 // ----------------------------------------------------------------------------
@@ -1897,6 +1919,148 @@ void EMU::force_out_debug_log(const _TCHAR* format, ...)
 #endif
 }
 
+// ----------------------------------------------------------------------------
+// trace log
+// ----------------------------------------------------------------------------
+
+#ifdef _TRACE_LOG
+#ifdef _MSC_VER
+unsigned __stdcall trace_log_thread(void *lpx)
+#else
+void* trace_log_thread(void *lpx)
+#endif
+{
+	EMU *emu = (EMU *)lpx;
+	
+	while(emu->flush_trace_log()) {
+		emu->sleep(100);
+	}
+#ifdef _MSC_VER
+	_endthreadex(0);
+	return 0;
+#else
+	pthread_exit(NULL);
+	return NULL;
+#endif
+}
+
+void EMU::initialize_trace_log()
+{
+	trace_log = _tfopen(create_date_file_path(_T("trace")), _T("w"));
+	trace_buffer = (_TCHAR *)malloc(TRACE_LOG_BUFFER_SIZE * sizeof(_TCHAR));
+	trace_flush_buffer = (_TCHAR *)malloc(TRACE_LOG_BUFFER_SIZE * sizeof(_TCHAR));
+	trace_write_ptr = trace_count = trace_lost = 0;
+	trace_request_terminate = false;
+#ifdef _MSC_VER
+	InitializeCriticalSection(&trace_lock);
+	hTraceThread = (HANDLE)_beginthreadex(NULL, 0, trace_log_thread, this, 0, NULL);
+#else
+	pthread_mutex_init(&trace_lock, NULL);
+	pthread_create(&trace_thread_id, NULL, trace_log_thread, this);
+#endif
+}
+
+void EMU::release_trace_log()
+{
+	// stop the thread, and write the rest of logs
+#ifdef _MSC_VER
+	EnterCriticalSection(&trace_lock);
+	trace_request_terminate = true;
+	LeaveCriticalSection(&trace_lock);
+	WaitForSingleObject(hTraceThread, INFINITE);
+	CloseHandle(hTraceThread);
+#else
+	pthread_mutex_lock(&trace_lock);
+	trace_request_terminate = true;
+	pthread_mutex_unlock(&trace_lock);
+	pthread_join(trace_thread_id, NULL);
+#endif
+	flush_trace_log();
+	
+	if(trace_log) {
+		fclose(trace_log);
+		trace_log = NULL;
+	}
+	free(trace_buffer);
+	free(trace_flush_buffer);
+#ifdef _MSC_VER
+	DeleteCriticalSection(&trace_lock);
+#else
+	pthread_mutex_destroy(&trace_lock);
+#endif
+}
+
+void EMU::out_trace_log(const _TCHAR* format, ...)
+{
+	va_list ap;
+	_TCHAR buffer[1024];
+	
+	va_start(ap, format);
+	my_vstprintf_s(buffer, 1024, format, ap);
+	va_end(ap);
+	int length = (int)_tcslen(buffer);
+	
+	// copy into the ring buffer, the log is lost when the thread can't write in time
+#ifdef _MSC_VER
+	EnterCriticalSection(&trace_lock);
+#else
+	pthread_mutex_lock(&trace_lock);
+#endif
+	if(trace_count + length > TRACE_LOG_BUFFER_SIZE) {
+		trace_lost += length;
+	} else {
+		int first = TRACE_LOG_BUFFER_SIZE - trace_write_ptr;
+		if(first > length) {
+			first = length;
+		}
+		memcpy(trace_buffer + trace_write_ptr, buffer, first * sizeof(_TCHAR));
+		memcpy(trace_buffer, buffer + first, (length - first) * sizeof(_TCHAR));
+		trace_write_ptr = (trace_write_ptr + length) % TRACE_LOG_BUFFER_SIZE;
+		trace_count += length;
+	}
+#ifdef _MSC_VER
+	LeaveCriticalSection(&trace_lock);
+#else
+	pthread_mutex_unlock(&trace_lock);
+#endif
+}
+
+bool EMU::flush_trace_log()
+{
+	// move the logs to the flush buffer, and write them to file without the lock
+#ifdef _MSC_VER
+	EnterCriticalSection(&trace_lock);
+#else
+	pthread_mutex_lock(&trace_lock);
+#endif
+	int count = trace_count;
+	int lost = trace_lost;
+	int read_ptr = (trace_write_ptr + TRACE_LOG_BUFFER_SIZE - count) % TRACE_LOG_BUFFER_SIZE;
+	int first = TRACE_LOG_BUFFER_SIZE - read_ptr;
+	if(first > count) {
+		first = count;
+	}
+	memcpy(trace_flush_buffer, trace_buffer + read_ptr, first * sizeof(_TCHAR));
+	memcpy(trace_flush_buffer + first, trace_buffer, (count - first) * sizeof(_TCHAR));
+	trace_count = trace_lost = 0;
+	bool terminate = trace_request_terminate;
+#ifdef _MSC_VER
+	LeaveCriticalSection(&trace_lock);
+#else
+	pthread_mutex_unlock(&trace_lock);
+#endif
+	
+	if(trace_log != NULL && (count != 0 || lost != 0)) {
+		fwrite(trace_flush_buffer, sizeof(_TCHAR), count, trace_log);
+		if(lost != 0) {
+			_ftprintf(trace_log, _T("*** %d characters are lost ***\n"), lost);
+		}
+		fflush(trace_log);
+	}
+	return !terminate;
+}
+#endif
+
 void EMU::out_message(const _TCHAR* format, ...)
 {
 	va_list ap;
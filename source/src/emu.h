@@ -20,6 +20,13 @@
 	// output i/o debug log
 //	#define _IO_DEBUG_LOG
 #endif
+// output trace log of the devices into the ring buffer, it is written to file by the thread
+//#define _TRACE_LOG
+#ifdef _TRACE_LOG
+	// categories of the trace log to output (see vm/device.h)
+	#define _TRACE_LOG_CATEGORIES	0xffffffff
+	#define TRACE_LOG_BUFFER_SIZE	0x100000
+#endif
 
 #include <stdio.h>
 #include <assert.h>
@@ -33,6 +40,9 @@
 #elif defined(_USE_SDL)
 #include <pthread.h>
 #define OSD_SDL
+#elif defined(_USE_HEADLESS)
+#include <pthread.h>
+#define OSD_HEADLESS
 #elif defined(_WIN32)
 #define OSD_WIN32
 #else
@@ -46,6 +56,8 @@
 #include "qt/osd.h"
 #elif defined(OSD_SDL)
 #include "sdl/osd.h"
+#elif defined(OSD_HEADLESS)
+#include "headless/osd.h"
 #elif defined(OSD_WIN32)
 #include "win32/osd.h"
 #endif
@@ -104,6 +116,24 @@ private:
 	FILE* debug_log;
 #endif
 	
+	// trace log
+#ifdef _TRACE_LOG
+	void initialize_trace_log();
+	void release_trace_log();
+	FILE* trace_log;
+	_TCHAR* trace_buffer;
+	_TCHAR* trace_flush_buffer;
+	int trace_write_ptr, trace_count, trace_lost;
+	bool trace_request_terminate;
+#ifdef _MSC_VER
+	HANDLE hTraceThread;
+	CRITICAL_SECTION trace_lock;
+#else
+	pthread_t trace_thread_id;
+	pthread_mutex_t trace_lock;
+#endif
+#endif
+	
 	// misc
 	int sound_frequency, sound_latency;
 	int sound_rate, sound_samples;
@@ -215,6 +245,7 @@ public:
 	double get_frame_rate();
 	int get_frame_interval();
 	bool is_frame_skippable();
+	void set_render_demand(bool value);
 	int run();
 	void reset();
 #ifdef USE_SPECIAL_RESET
@@ -311,6 +342,8 @@ public:
 	void start_record_sound();
 	void stop_record_sound();
 	bool is_sound_recording();
+	bool start_record_sound_stems(const _TCHAR* prefix);
+	void stop_record_sound_stems();
 	
 	// video device
 #if defined(USE_MOVIE_PLAYER) || defined(USE_VIDEO_CAPTURE)
@@ -384,6 +417,8 @@ public:
 #if defined(OSD_QT)
 	pthread_t debugger_thread_id;
 	CSP_Debugger *hDebugger;
+#elif defined(OSD_HEADLESS)
+	pthread_t debugger_thread_id;
 #elif defined(OSD_WIN32)
 	HANDLE hDebuggerThread;
 #else
@@ -398,6 +433,10 @@ public:
 	// debug log
 	void out_debug_log(const _TCHAR* format, ...);
 	void force_out_debug_log(const _TCHAR* format, ...);
+#ifdef _TRACE_LOG
+	void out_trace_log(const _TCHAR* format, ...);
+	bool flush_trace_log();
+#endif
 	
 	void out_message(const _TCHAR* format, ...);
 	int message_count;
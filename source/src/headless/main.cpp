@@ -0,0 +1,493 @@
+/*
+	Skelton for retropc emulator
+
+	Date   : 2026.10.17-
+
+	[ headless main ]
+
+	Runs the virtual machine without any window, sound device or input.
+	VM::run() is driven in a tight loop without any pacing, and the screen
+	and the sound can be written to files.
+
+	-batch runs the tape images listed in the file one by one, and reports
+	the statistics and the screen hash of each image.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../emu.h"
+#include "../fileio.h"
+#include "../vm/device.h"
+#include "../vm/debugger.h"
+
+// emulation core
+EMU* emu;
+
+typedef struct {
+	int frames;
+	int tape_frames;
+	uint64_t cpu_clocks;
+	uint64_t fired_events;
+	uint64_t redrawn_rows;
+	double sec;
+} run_stats_t;
+
+static int pcm_id = -1;
+static const char *dump_prefix = NULL;
+static int dump_interval = 0, dump_count = 0;
+static const char *heatmap_prefix = NULL;
+static int heatmap_interval = 0, heatmap_count = 0;
+static bool drain_sound = false;
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "usage: %s [options]\n", name);
+	fprintf(stderr, "  -frames <n>        run n frames (default 600)\n");
+	fprintf(stderr, "  -cycles <n>        run until cpu runs n clocks\n");
+	fprintf(stderr, "  -cpu-power <n>     run cpu 2^n times faster (0-4)\n");
+	fprintf(stderr, "  -tape <file>       play the tape image\n");
+	fprintf(stderr, "  -turbo             skip rendering while the cassette motor is on\n");
+	fprintf(stderr, "  -batch <list>      run each tape image in the list file after reset\n");
+#ifdef USE_ACCURATE_RASTER
+	fprintf(stderr, "  -raster            draw the writes while the beam passes the line\n");
+#endif
+#ifdef USE_BAND_LIMITED_SOUND
+	fprintf(stderr, "  -band-limited      synthesize the sound with band-limited steps\n");
+#endif
+#ifdef USE_QUICK_DISK
+	fprintf(stderr, "  -qd <file>         open the quick disk image\n");
+#endif
+#ifdef USE_FLOPPY_DISK
+	fprintf(stderr, "  -fd <drv> <file>   open the floppy disk image\n");
+#endif
+	fprintf(stderr, "  -screenshot <file> write the last screen to bmp file\n");
+	fprintf(stderr, "  -dump <n> <prefix> write the screen to bmp file every n frames\n");
+	fprintf(stderr, "  -wav <file>        record the sound to wav file\n");
+	fprintf(stderr, "  -pcm <file>        write the sound to raw pcm file (s16le, stereo)\n");
+	fprintf(stderr, "  -stems <prefix>    record each sound device to <prefix>_<n>_<device>.wav\n");
+#ifdef USE_STATE
+	fprintf(stderr, "  -load-state <file> load the state file before running\n");
+	fprintf(stderr, "  -save-state <file> save the state file after running\n");
+#endif
+	fprintf(stderr, "  -hash              print the hash of the last screen\n");
+#ifdef USE_DEBUGGER
+	fprintf(stderr, "  -debugger          open the debugger console on the standard input/output\n");
+	fprintf(stderr, "  -trace <file>      write the execution trace of cpu after running\n");
+	fprintf(stderr, "  -decode-trace <file> <text>\n");
+	fprintf(stderr, "                     decode the execution trace file to text file\n");
+	fprintf(stderr, "  -symbols <file>    load the symbol file for the profile and trace\n");
+	fprintf(stderr, "  -profile <file> <folded>\n");
+	fprintf(stderr, "                     write the profile of cpu and the collapsed stacks\n");
+	fprintf(stderr, "  -heatmap <n> <prefix>\n");
+	fprintf(stderr, "                     write the memory access heatmap every n frames\n");
+	fprintf(stderr, "                     (n = 0: once for all frames)\n");
+	fprintf(stderr, "  -watch <addr>[-<addr>]\n");
+	fprintf(stderr, "                     watch the memory accesses in the range\n");
+#endif
+}
+
+static uint64_t get_screen_hash()
+{
+	uint64_t hash = 14695981039346656037ULL;
+	for(int y = 0; y < SCREEN_HEIGHT; y++) {
+		uint8_t *p = (uint8_t *)emu->get_osd()->get_vm_screen_buffer(y);
+		for(int x = 0; x < (int)(SCREEN_WIDTH * sizeof(scrntype_t)); x++) {
+			hash = (hash ^ p[x]) * 1099511628211ULL;
+		}
+	}
+	return hash;
+}
+
+static double get_host_sec()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1000000000.0;
+}
+
+#ifdef USE_DEBUGGER
+static void write_heatmap(const char *name)
+{
+	DEVICE *cpu = emu->get_vm()->get_cpu(0);
+	char image_path[_MAX_PATH], report_path[_MAX_PATH];
+	
+	snprintf(image_path, sizeof(image_path), "%s%s.bmp", heatmap_prefix, name);
+	snprintf(report_path, sizeof(report_path), "%s%s.txt", heatmap_prefix, name);
+	if(!cpu->save_debug_heatmap(image_path, report_path)) {
+		fprintf(stderr, "can't write %s (define Z80_MEMORY_HEATMAP to count)\n", image_path);
+	}
+	cpu->clear_debug_heatmap();
+}
+#endif
+
+static void run_frames(int frames, uint64_t cycles, run_stats_t *stats)
+{
+	VM_TEMPLATE *vm = emu->get_vm();
+	OSD *osd = emu->get_osd();
+	uint64_t start_clocks = vm->get_total_cpu_clocks();
+	uint64_t start_events = vm->get_total_fired_events();
+	uint64_t start_rows = vm->get_total_redrawn_rows();
+	double start_sec = get_host_sec();
+	int16_t pcm_buffer[1024 * 2];
+	int count = 0, tape_count = 0;
+	
+	while(cycles != 0 ? (vm->get_total_cpu_clocks() - start_clocks < cycles) : (count < frames)) {
+		// drive virtual machine directly, the sound is created only when it is used
+		// and the screen is drawn only in the frames that are dumped
+		bool last = (cycles == 0 && count + 1 == frames);
+		vm->set_render_demand(last || (dump_interval > 0 && ((count + 1) % dump_interval) == 0));
+		vm->run();
+		count++;
+		if(vm->is_tape_playing(0)) {
+			tape_count++;
+		}
+		if(drain_sound) {
+			int extra_frames;
+			osd->update_sound(&extra_frames);
+			if(pcm_id != -1) {
+				int samples;
+				while((samples = osd->read_sound_ring(pcm_buffer, 1024)) > 0) {
+					osd->get_sound_writer()->write(pcm_id, pcm_buffer, samples);
+				}
+			}
+		}
+		if(dump_interval > 0 && (count % dump_interval) == 0) {
+			char path[_MAX_PATH];
+			vm->draw_screen();
+			snprintf(path, sizeof(path), "%s%06d.bmp", dump_prefix, dump_count++);
+			osd->write_screen_to_file(path);
+		}
+#ifdef USE_DEBUGGER
+		if(heatmap_prefix != NULL && heatmap_interval > 0 && (count % heatmap_interval) == 0) {
+			char name[16];
+			snprintf(name, sizeof(name), "%06d", heatmap_count++);
+			write_heatmap(name);
+		}
+#endif
+	}
+	vm->draw_screen();
+	
+	stats->frames = count;
+	stats->tape_frames = tape_count;
+	stats->cpu_clocks = vm->get_total_cpu_clocks() - start_clocks;
+	stats->fired_events = vm->get_total_fired_events() - start_events;
+	stats->redrawn_rows = vm->get_total_redrawn_rows() - start_rows;
+	stats->sec = get_host_sec() - start_sec;
+}
+
+static void print_stats(const run_stats_t *stats)
+{
+	double vm_sec = stats->frames / emu->get_frame_rate();
+	double sec = (stats->sec > 0) ? stats->sec : 1e-9;
+	
+	printf("frames  : %d (%.2f sec in vm)\n", stats->frames, vm_sec);
+	printf("elapsed : %.3f sec (%.1fx)\n", stats->sec, vm_sec / sec);
+	printf("cpu     : %.2f MHz (%llu clocks)\n", stats->cpu_clocks / sec / 1000000.0, (unsigned long long)stats->cpu_clocks);
+	printf("fps     : %.1f\n", stats->frames / sec);
+	printf("events  : %llu (%.1f per frame)\n", (unsigned long long)stats->fired_events, stats->frames ? (double)stats->fired_events / stats->frames : 0.0);
+	printf("render  : %.2f rows redrawn per frame\n", stats->frames ? (double)stats->redrawn_rows / stats->frames : 0.0);
+	printf("host    : %.0f ns per frame\n", stats->sec * 1000000000.0 / max(stats->frames, 1));
+	printf("tape    : %d frames with the motor on (%.2f sec in vm)\n", stats->tape_frames, stats->tape_frames / emu->get_frame_rate());
+}
+
+static void load_tape(const char *path)
+{
+	VM_TEMPLATE *vm = emu->get_vm();
+	
+	// bypass the ejecting wait in EMU::play_tape
+	if(vm->is_tape_inserted(0)) {
+		vm->close_tape(0);
+	}
+	vm->play_tape(0, path);
+}
+
+#ifdef USE_DEBUGGER
+static void load_symbols(const char *path)
+{
+	DEBUGGER *debugger = (DEBUGGER *)emu->get_vm()->get_cpu(0)->get_debugger();
+	FILE *fp = fopen(path, "r");
+	char line[1024];
+	
+	if(fp == NULL) {
+		fprintf(stderr, "can't open %s\n", path);
+		return;
+	}
+	// same format as the symbol file of L command in the debugger
+	while(fgets(line, sizeof(line), fp) != NULL) {
+		char *next = NULL;
+		char *addr = my_tcstok_s(line, "\t #$*,;\r\n", &next);
+		char *name = (addr != NULL) ? my_tcstok_s(NULL, "\t #$*,;\r\n", &next) : NULL;
+		if(name != NULL) {
+			debugger->add_symbol(strtoul(addr, NULL, 16), name);
+		}
+	}
+	fclose(fp);
+}
+#endif
+
+static int run_batch(const char *list_path, int frames, uint64_t cycles, bool print_hash)
+{
+	FILE *fp = fopen(list_path, "r");
+	char line[_MAX_PATH];
+	run_stats_t total;
+	int count = 0;
+	
+	if(fp == NULL) {
+		fprintf(stderr, "can't open %s\n", list_path);
+		return 1;
+	}
+	memset(&total, 0, sizeof(total));
+	
+	while(fgets(line, sizeof(line), fp) != NULL) {
+		line[strcspn(line, "\r\n")] = '\0';
+		if(line[0] == '\0' || line[0] == '#') {
+			continue;
+		}
+		run_stats_t stats;
+		emu->reset();
+		load_tape(line);
+		run_frames(frames, cycles, &stats);
+		
+		// path, frames, cpu MHz, frames/sec, fired events, host ns per frame, frames with the motor on (, screen hash)
+		double sec = (stats.sec > 0) ? stats.sec : 1e-9;
+		printf("%s\t%d\t%.2f\t%.1f\t%llu\t%.0f\t%d", line, stats.frames,
+			stats.cpu_clocks / sec / 1000000.0, stats.frames / sec,
+			(unsigned long long)stats.fired_events, stats.sec * 1000000000.0 / max(stats.frames, 1), stats.tape_frames);
+		if(print_hash) {
+			printf("\t%016llx", (unsigned long long)get_screen_hash());
+		}
+		printf("\n");
+		fflush(stdout);
+		
+		total.frames += stats.frames;
+		total.tape_frames += stats.tape_frames;
+		total.cpu_clocks += stats.cpu_clocks;
+		total.fired_events += stats.fired_events;
+		total.redrawn_rows += stats.redrawn_rows;
+		total.sec += stats.sec;
+		count++;
+	}
+	fclose(fp);
+	
+	printf("images  : %d\n", count);
+	print_stats(&total);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int frames = 600;
+	uint64_t cycles = 0;
+	const char *tape_path = NULL, *batch_path = NULL;
+#ifdef USE_QUICK_DISK
+	const char *qd_path = NULL;
+#endif
+#ifdef USE_FLOPPY_DISK
+	const char *fd_path = NULL;
+	int fd_drv = 0;
+#endif
+	const char *screenshot_path = NULL, *wav_path = NULL, *pcm_path = NULL, *stems_prefix = NULL;
+	const char *load_state_path = NULL, *save_state_path = NULL;
+	const char *trace_path = NULL, *decode_path = NULL;
+	const char *profile_path = NULL, *stack_path = NULL, *symbol_path = NULL;
+	uint32_t watch_start[256], watch_end[256];
+	int watch_count = 0;
+	int cpu_power = 0;
+	bool print_hash = false, tape_turbo = false, accurate_raster = false;
+	bool band_limited = false;
+	bool open_debugger = false;
+	int result = 0;
+
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "-frames") == 0 && i + 1 < argc) {
+			frames = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-cycles") == 0 && i + 1 < argc) {
+			cycles = strtoull(argv[++i], NULL, 0);
+		} else if(strcmp(argv[i], "-cpu-power") == 0 && i + 1 < argc) {
+			cpu_power = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-tape") == 0 && i + 1 < argc) {
+			tape_path = argv[++i];
+		} else if(strcmp(argv[i], "-turbo") == 0) {
+			tape_turbo = true;
+		} else if(strcmp(argv[i], "-raster") == 0) {
+			accurate_raster = true;
+		} else if(strcmp(argv[i], "-band-limited") == 0) {
+			band_limited = true;
+		} else if(strcmp(argv[i], "-batch") == 0 && i + 1 < argc) {
+			batch_path = argv[++i];
+#ifdef USE_QUICK_DISK
+		} else if(strcmp(argv[i], "-qd") == 0 && i + 1 < argc) {
+			qd_path = argv[++i];
+#endif
+#ifdef USE_FLOPPY_DISK
+		} else if(strcmp(argv[i], "-fd") == 0 && i + 2 < argc) {
+			fd_drv = atoi(argv[++i]);
+			fd_path = argv[++i];
+#endif
+		} else if(strcmp(argv[i], "-screenshot") == 0 && i + 1 < argc) {
+			screenshot_path = argv[++i];
+		} else if(strcmp(argv[i], "-dump") == 0 && i + 2 < argc) {
+			dump_interval = atoi(argv[++i]);
+			dump_prefix = argv[++i];
+		} else if(strcmp(argv[i], "-wav") == 0 && i + 1 < argc) {
+			wav_path = argv[++i];
+		} else if(strcmp(argv[i], "-pcm") == 0 && i + 1 < argc) {
+			pcm_path = argv[++i];
+		} else if(strcmp(argv[i], "-stems") == 0 && i + 1 < argc) {
+			stems_prefix = argv[++i];
+		} else if(strcmp(argv[i], "-load-state") == 0 && i + 1 < argc) {
+			load_state_path = argv[++i];
+		} else if(strcmp(argv[i], "-save-state") == 0 && i + 1 < argc) {
+			save_state_path = argv[++i];
+		} else if(strcmp(argv[i], "-hash") == 0) {
+			print_hash = true;
+#ifdef USE_DEBUGGER
+		} else if(strcmp(argv[i], "-trace") == 0 && i + 1 < argc) {
+			trace_path = argv[++i];
+		} else if(strcmp(argv[i], "-decode-trace") == 0 && i + 2 < argc) {
+			decode_path = argv[++i];
+			trace_path = argv[++i];
+		} else if(strcmp(argv[i], "-heatmap") == 0 && i + 2 < argc) {
+			heatmap_interval = atoi(argv[++i]);
+			heatmap_prefix = argv[++i];
+		} else if(strcmp(argv[i], "-watch") == 0 && i + 1 < argc) {
+			char *end = NULL;
+			watch_start[watch_count] = strtoul(argv[++i], &end, 16);
+			watch_end[watch_count] = (*end == '-') ? strtoul(end + 1, NULL, 16) : watch_start[watch_count];
+			if(watch_count < 255) {
+				watch_count++;
+			}
+		} else if(strcmp(argv[i], "-debugger") == 0) {
+			open_debugger = true;
+		} else if(strcmp(argv[i], "-symbols") == 0 && i + 1 < argc) {
+			symbol_path = argv[++i];
+		} else if(strcmp(argv[i], "-profile") == 0 && i + 2 < argc) {
+			profile_path = argv[++i];
+			stack_path = argv[++i];
+#endif
+		} else {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	// initialize emulation core
+	initialize_config();
+	config.cpu_power = cpu_power;
+	config.tape_turbo = tape_turbo;
+#ifdef USE_ACCURATE_RASTER
+	config.accurate_raster = accurate_raster;
+#endif
+#ifdef USE_BAND_LIMITED_SOUND
+	config.sound_band_limited = band_limited;
+#endif
+	emu = new EMU();
+
+#ifdef USE_DEBUGGER
+	if(symbol_path != NULL) {
+		load_symbols(symbol_path);
+	}
+	for(int i = 0; i < watch_count; i++) {
+		for(uint32_t addr = watch_start[i]; addr <= watch_end[i] && addr <= 0xffff; addr++) {
+			emu->get_vm()->get_cpu(0)->set_debug_watch(addr, true);
+		}
+	}
+	if(decode_path != NULL) {
+		// the disassembler of cpu is used to decode
+		if(!emu->get_vm()->get_cpu(0)->decode_debug_trace(decode_path, trace_path)) {
+			fprintf(stderr, "can't decode %s\n", decode_path);
+			result = 1;
+		}
+		delete emu;
+		return result;
+	}
+	if(open_debugger) {
+		// the emulation is suspended while the debugger waits for the command
+		emu->open_debugger(0);
+	}
+#endif
+#ifdef USE_STATE
+	if(load_state_path != NULL) {
+		emu->load_state(load_state_path);
+	}
+#endif
+	if(tape_path != NULL) {
+		load_tape(tape_path);
+	}
+#ifdef USE_QUICK_DISK
+	if(qd_path != NULL) {
+		emu->open_quick_disk(0, qd_path);
+	}
+#endif
+#ifdef USE_FLOPPY_DISK
+	if(fd_path != NULL) {
+		emu->open_floppy_disk(fd_drv, fd_path, 0);
+	}
+#endif
+	if(wav_path != NULL) {
+		drain_sound = emu->get_osd()->start_record_sound(wav_path);
+	}
+	if(pcm_path != NULL) {
+		if((pcm_id = emu->get_osd()->get_sound_writer()->open(pcm_path, emu->get_sound_rate(), false)) != -1) {
+			drain_sound = true;
+		} else {
+			fprintf(stderr, "can't open %s\n", pcm_path);
+		}
+	}
+	if(stems_prefix != NULL) {
+		if(emu->start_record_sound_stems(stems_prefix)) {
+			drain_sound = true;
+		} else {
+			fprintf(stderr, "can't open the stem files %s_*.wav\n", stems_prefix);
+		}
+	}
+
+	if(batch_path != NULL) {
+		result = run_batch(batch_path, frames, cycles, print_hash);
+	} else {
+		run_stats_t stats;
+		run_frames(frames, cycles, &stats);
+		print_stats(&stats);
+		if(print_hash) {
+			printf("screen  : %016llx\n", (unsigned long long)get_screen_hash());
+		}
+	}
+	if(screenshot_path != NULL) {
+		emu->get_osd()->write_screen_to_file(screenshot_path);
+	}
+	if(wav_path != NULL) {
+		emu->get_osd()->stop_record_sound();
+	}
+	if(pcm_id != -1) {
+		emu->get_osd()->get_sound_writer()->close(pcm_id);
+	}
+	if(stems_prefix != NULL) {
+		emu->stop_record_sound_stems();
+	}
+#ifdef USE_STATE
+	if(save_state_path != NULL) {
+		emu->save_state(save_state_path);
+	}
+#endif
+#ifdef USE_DEBUGGER
+	if(trace_path != NULL) {
+		if(!emu->get_vm()->get_cpu(0)->save_debug_trace(trace_path)) {
+			fprintf(stderr, "can't write %s (define Z80_EXEC_TRACE to record)\n", trace_path);
+		}
+	}
+	if(profile_path != NULL) {
+		if(!emu->get_vm()->get_cpu(0)->save_debug_profile(profile_path, stack_path)) {
+			fprintf(stderr, "can't write %s (define Z80_PROFILER to count)\n", profile_path);
+		}
+	}
+	if(heatmap_prefix != NULL && heatmap_interval == 0) {
+		write_heatmap("");
+	}
+#endif
+
+	// release emulation core
+	delete emu;
+	return result;
+}
@@ -0,0 +1,84 @@
+/*
+	Skelton for retropc emulator
+
+	Author : Takeda.Toshiya
+	Date   : 2015.11.20-
+
+	[ headless dependent ]
+*/
+
+#include "osd.h"
+
+void OSD::initialize(int rate, int samples)
+{
+	pthread_mutex_init(&vm_mutex, NULL);
+	
+	initialize_console();
+	initialize_input();
+	initialize_screen();
+	initialize_sound(rate, samples);
+}
+
+void OSD::release()
+{
+	release_console();
+	release_input();
+	release_screen();
+	release_sound();
+	
+	pthread_mutex_destroy(&vm_mutex);
+}
+
+void OSD::power_off()
+{
+}
+
+void OSD::suspend()
+{
+	mute_sound();
+}
+
+void OSD::restore()
+{
+}
+
+void OSD::lock_vm()
+{
+	if(lock_count++ == 0) {
+		pthread_mutex_lock(&vm_mutex);
+	}
+}
+
+void OSD::unlock_vm()
+{
+	if(--lock_count <= 0) {
+		force_unlock_vm();
+	}
+}
+
+void OSD::force_unlock_vm()
+{
+	if(lock_count != 0) {
+		lock_count = 0;
+	}
+	pthread_mutex_unlock(&vm_mutex);
+}
+
+void OSD::sleep(uint32_t ms)
+{
+	usleep(ms * 1000);
+}
+
+#ifdef USE_DEBUGGER
+void OSD::start_waiting_in_debugger()
+{
+}
+
+void OSD::finish_waiting_in_debugger()
+{
+}
+
+void OSD::process_waiting_in_debugger()
+{
+}
+#endif
@@ -0,0 +1,304 @@
+/*
+	Skelton for retropc emulator
+
+	Author : Takeda.Toshiya
+	Date   : 2015.11.20-
+
+	[ headless dependent ]
+*/
+
+#ifndef _HEADLESS_OSD_H_
+#define _HEADLESS_OSD_H_
+
+#include <pthread.h>
+#include <unistd.h>
+#include "../vm/vm.h"
+//#include "../emu.h"
+#include "../common.h"
+#include "../config.h"
+#include "../sound_ring.h"
+#include "../sound_writer.h"
+
+// virtual key codes referred by the common code (same values as windows)
+#define VK_SHIFT	0x10
+#define VK_CONTROL	0x11
+#define VK_MENU		0x12
+#define VK_ESCAPE	0x1b
+#define VK_LSHIFT	0xa0
+#define VK_RSHIFT	0xa1
+#define VK_LCONTROL	0xa2
+#define VK_RCONTROL	0xa3
+#define VK_LMENU	0xa4
+#define VK_RMENU	0xa5
+
+#define SCREEN_FILTER_NONE	0
+#define SCREEN_FILTER_RGB	1
+#define SCREEN_FILTER_RF	2
+
+// osd common
+
+#define OSD_CONSOLE_BLUE	1 // text color contains blue
+#define OSD_CONSOLE_GREEN	2 // text color contains green
+#define OSD_CONSOLE_RED		4 // text color contains red
+#define OSD_CONSOLE_INTENSITY	8 // text color is intensified
+
+typedef struct bitmap_s {
+	// common
+	inline bool initialized()
+	{
+		return (lpBmp != NULL);
+	}
+	inline scrntype_t* get_buffer(int y)
+	{
+		return lpBmp + width * y;
+	}
+	int width, height;
+	// headless dependent
+	scrntype_t* lpBmp;
+} bitmap_t;
+
+typedef struct font_s {
+	// common
+	inline bool initialized()
+	{
+		return (family[0] != _T('\0'));
+	}
+	_TCHAR family[64];
+	int width, height, rotate;
+	bool bold, italic;
+} font_t;
+
+typedef struct pen_s {
+	// common
+	inline bool initialized()
+	{
+		return (width != 0);
+	}
+	int width;
+	uint8_t r, g, b;
+} pen_t;
+
+class FIFO;
+class FILEIO;
+
+class OSD
+{
+private:
+	int lock_count;
+	pthread_mutex_t vm_mutex;
+
+	// console
+	void initialize_console();
+	void release_console();
+
+	int console_count;
+
+	// input
+	void initialize_input();
+	void release_input();
+
+	uint8_t key_status[256];	// windows key code mapping
+	bool lost_focus;
+
+#ifdef USE_JOYSTICK
+	uint32_t joy_status[4];
+#endif
+#ifdef USE_MOUSE
+	int32_t mouse_status[3];	// x, y, button (b0 = left, b1 = right)
+	bool mouse_enabled;
+#endif
+
+	// screen
+	void initialize_screen();
+	void release_screen();
+	void initialize_screen_buffer(bitmap_t *buffer, int width, int height);
+	void release_screen_buffer(bitmap_t *buffer);
+
+	bitmap_t vm_screen_buffer;
+
+	int vm_screen_width, vm_screen_height;
+	int vm_window_width, vm_window_height;
+	int vm_window_width_aspect, vm_window_height_aspect;
+
+	// sound
+	void initialize_sound(int rate, int samples);
+	void release_sound();
+
+	int sound_rate, sound_samples;
+	bool sound_available, sound_muted;
+
+	_TCHAR sound_file_path[_MAX_PATH];
+	int rec_sound_id;
+	int rec_sound_buffer_ptr;
+	
+	// recorded samples are written to files by the thread
+	SOUND_WRITER sound_writer;
+	
+	// created samples are kept in the ring buffer until the host reads them,
+	// and the newest samples are dropped when the host does not catch up
+	SOUND_RING sound_ring;
+
+public:
+	OSD()
+	{
+		lock_count = 0;
+	}
+	~OSD() {}
+
+	// common
+	VM_TEMPLATE* vm;
+
+	void initialize(int rate, int samples);
+	void release();
+	void power_off();
+	void suspend();
+	void restore();
+	void lock_vm();
+	void unlock_vm();
+	bool is_vm_locked()
+	{
+		return (lock_count != 0);
+	}
+	void force_unlock_vm();
+	void sleep(uint32_t ms);
+
+	// common debugger
+#ifdef USE_DEBUGGER
+	void start_waiting_in_debugger();
+	void finish_waiting_in_debugger();
+	void process_waiting_in_debugger();
+#endif
+
+	// common console
+	void open_console(int width, int height, const _TCHAR* title);
+	void close_console();
+	unsigned int get_console_code_page();
+	bool is_console_active();
+	void set_console_text_attribute(unsigned short attr);
+	void write_console(const _TCHAR* buffer, unsigned int length);
+	int read_console_input(_TCHAR* buffer, unsigned int length);
+	bool is_console_key_pressed(int vk);
+	void close_debugger_console();
+
+	// common input
+	void update_input();
+	void key_down(int code, bool extended, bool repeat);
+	void key_up(int code, bool extended);
+	void key_down_native(int code, bool repeat);
+	void key_up_native(int code);
+	void key_lost_focus()
+	{
+		lost_focus = true;
+	}
+#ifdef USE_MOUSE
+	void enable_mouse();
+	void disable_mouse();
+	void toggle_mouse();
+	bool is_mouse_enabled()
+	{
+		return mouse_enabled;
+	}
+#endif
+	uint8_t* get_key_buffer()
+	{
+		return key_status;
+	}
+#ifdef USE_JOYSTICK
+	uint32_t* get_joy_buffer()
+	{
+		return joy_status;
+	}
+#endif
+#ifdef USE_MOUSE
+	int32_t* get_mouse_buffer()
+	{
+		return mouse_status;
+	}
+#endif
+#ifdef USE_AUTO_KEY
+	bool now_auto_key;
+#endif
+
+	// common screen
+	double get_window_mode_power(int mode);
+	int get_window_mode_width(int mode);
+	int get_window_mode_height(int mode);
+	void set_host_window_size(int window_width, int window_height, bool window_mode);
+	void set_vm_screen_size(int screen_width, int screen_height, int window_width, int window_height, int window_width_aspect, int window_height_aspect);
+	void set_vm_screen_lines(int lines);
+	int get_vm_window_width()
+	{
+		return vm_window_width;
+	}
+	int get_vm_window_height()
+	{
+		return vm_window_height;
+	}
+	int get_vm_window_width_aspect()
+	{
+		return vm_window_width_aspect;
+	}
+	int get_vm_window_height_aspect()
+	{
+		return vm_window_height_aspect;
+	}
+	scrntype_t* get_vm_screen_buffer(int y);
+	int draw_screen();
+#ifdef ONE_BOARD_MICRO_COMPUTER
+	void reload_bitmap() {}
+#endif
+	void capture_screen();
+	bool start_record_video(int fps);
+	void stop_record_video();
+	void restart_record_video();
+	void add_extra_frames(int extra_frames);
+	bool now_record_video;
+#ifdef USE_SCREEN_FILTER
+	bool screen_skip_line;
+#endif
+
+	// common sound
+	void update_sound(int* extra_frames);
+	void mute_sound();
+	void stop_sound();
+	void start_record_sound();
+	void stop_record_sound();
+	void restart_record_sound();
+	bool now_record_sound;
+	SOUND_WRITER* get_sound_writer()
+	{
+		return &sound_writer;
+	}
+
+	// common printer
+#ifdef USE_PRINTER
+	void create_bitmap(bitmap_t *bitmap, int width, int height);
+	void release_bitmap(bitmap_t *bitmap);
+	void create_font(font_t *font, const _TCHAR *family, int width, int height, int rotate, bool bold, bool italic);
+	void release_font(font_t *font);
+	void create_pen(pen_t *pen, int width, uint8_t r, uint8_t g, uint8_t b);
+	void release_pen(pen_t *pen);
+	void clear_bitmap(bitmap_t *bitmap, uint8_t r, uint8_t g, uint8_t b);
+	int get_text_width(bitmap_t *bitmap, font_t *font, const char *text);
+	void draw_text_to_bitmap(bitmap_t *bitmap, font_t *font, int x, int y, const char *text, uint8_t r, uint8_t g, uint8_t b);
+	void draw_line_to_bitmap(bitmap_t *bitmap, pen_t *pen, int sx, int sy, int ex, int ey);
+	void draw_rectangle_to_bitmap(bitmap_t *bitmap, int x, int y, int width, int height, uint8_t r, uint8_t g, uint8_t b);
+	void draw_point_to_bitmap(bitmap_t *bitmap, int x, int y, uint8_t r, uint8_t g, uint8_t b);
+	void stretch_bitmap(bitmap_t *dest, int dest_x, int dest_y, int dest_width, int dest_height, bitmap_t *source, int source_x, int source_y, int source_width, int source_height);
+#endif
+	void write_bitmap_to_file(bitmap_t *bitmap, const _TCHAR *file_path);
+
+	// headless dependent
+	bool write_screen_to_file(const _TCHAR *file_path);
+	bool start_record_sound(const _TCHAR *file_path);
+	int get_sound_ring_count()
+	{
+		return sound_ring.get_count();
+	}
+	int read_sound_ring(int16_t* buffer, int samples)
+	{
+		return sound_ring.read(buffer, samples);
+	}
+};
+
+#endif
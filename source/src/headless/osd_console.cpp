@@ -0,0 +1,98 @@
+/*
+	Skelton for retropc emulator
+
+	Author : Takeda.Toshiya
+	Date   : 2015.11.26-
+
+	[ headless console ]
+*/
+
+#include "osd.h"
+#include <sys/select.h>
+
+void OSD::initialize_console()
+{
+	console_count = 0;
+}
+
+void OSD::release_console()
+{
+	close_console();
+}
+
+void OSD::open_console(int width, int height, const _TCHAR* title)
+{
+	// the console is the standard input/output of this process
+	console_count++;
+}
+
+void OSD::close_console()
+{
+	if(console_count > 0) {
+		console_count--;
+	}
+}
+
+unsigned int OSD::get_console_code_page()
+{
+	return 0;
+}
+
+bool OSD::is_console_active()
+{
+	return (console_count > 0);
+}
+
+void OSD::set_console_text_attribute(unsigned short attr)
+{
+	int color = 0;
+	
+	if(attr & OSD_CONSOLE_RED  ) color |= 1;
+	if(attr & OSD_CONSOLE_GREEN) color |= 2;
+	if(attr & OSD_CONSOLE_BLUE ) color |= 4;
+	
+	if(isatty(STDOUT_FILENO)) {
+		fprintf(stdout, "\x1b[%d;%dm", (attr & OSD_CONSOLE_INTENSITY) ? 1 : 0, 30 + color);
+	}
+}
+
+void OSD::write_console(const _TCHAR* buffer, unsigned int length)
+{
+	fwrite(buffer, sizeof(_TCHAR), length, stdout);
+	fflush(stdout);
+}
+
+int OSD::read_console_input(_TCHAR* buffer, unsigned int length)
+{
+	unsigned int count = 0;
+	
+	while(count < length) {
+		fd_set fds;
+		struct timeval tv = {0, 0};
+		FD_ZERO(&fds);
+		FD_SET(STDIN_FILENO, &fds);
+		if(select(STDIN_FILENO + 1, &fds, NULL, NULL, &tv) <= 0) {
+			break;
+		}
+		char c;
+		if(read(STDIN_FILENO, &c, 1) != 1) {
+			break;
+		}
+		buffer[count++] = (c == '\n') ? 0x0d : c;
+		if(c == '\n') {
+			// the rest is read with the next command when the commands are piped
+			break;
+		}
+	}
+	return count;
+}
+
+bool OSD::is_console_key_pressed(int vk)
+{
+	return false;
+}
+
+void OSD::close_debugger_console()
+{
+	close_console();
+}
@@ -0,0 +1,180 @@
+/*
+	Skelton for retropc emulator
+
+	Author : Takeda.Toshiya
+	Date   : 2015.11.26-
+
+	[ headless input ]
+*/
+
+#include "osd.h"
+
+void OSD::initialize_input()
+{
+	memset(key_status, 0, sizeof(key_status));
+#ifdef USE_JOYSTICK
+	memset(joy_status, 0, sizeof(joy_status));
+#endif
+#ifdef USE_MOUSE
+	memset(mouse_status, 0, sizeof(mouse_status));
+	mouse_enabled = false;
+#endif
+	lost_focus = false;
+#ifdef USE_AUTO_KEY
+	now_auto_key = false;
+#endif
+}
+
+void OSD::release_input()
+{
+}
+
+void OSD::update_input()
+{
+	// release keys
+#ifdef USE_AUTO_KEY
+	if(lost_focus && !now_auto_key) {
+#else
+	if(lost_focus) {
+#endif
+		// we lost key focus so release all pressed keys
+		for(int i = 0; i < 256; i++) {
+			if(key_status[i] & 0x80) {
+				key_status[i] &= 0x7f;
+				if(!key_status[i]) {
+					vm->key_up(i);
+				}
+			}
+		}
+	} else {
+		for(int i = 0; i < 256; i++) {
+			if(key_status[i] & 0x7f) {
+				key_status[i] = (key_status[i] & 0x80) | ((key_status[i] & 0x7f) - 1);
+				if(!key_status[i]) {
+					vm->key_up(i);
+				}
+			}
+		}
+	}
+	lost_focus = false;
+	
+	// VK_$00 should be 0
+	key_status[0] = 0;
+}
+
+void OSD::key_down(int code, bool extended, bool repeat)
+{
+#ifdef USE_AUTO_KEY
+	if(!now_auto_key && !config.romaji_to_kana) {
+#endif
+		if(code == VK_SHIFT) {
+			code = VK_LSHIFT;
+		} else if(code == VK_CONTROL) {
+			code = VK_LCONTROL;
+		} else if(code == VK_MENU) {
+			code = VK_LMENU;
+		}
+		key_down_native(code, repeat);
+#ifdef USE_AUTO_KEY
+	}
+#endif
+}
+
+void OSD::key_up(int code, bool extended)
+{
+#ifdef USE_AUTO_KEY
+	if(!now_auto_key && !config.romaji_to_kana) {
+#endif
+		if(code == VK_SHIFT) {
+			code = VK_LSHIFT;
+		} else if(code == VK_CONTROL) {
+			code = VK_LCONTROL;
+		} else if(code == VK_MENU) {
+			code = VK_LMENU;
+		}
+		key_up_native(code);
+#ifdef USE_AUTO_KEY
+	}
+#endif
+}
+
+void OSD::key_down_native(int code, bool repeat)
+{
+	if(key_status[code] == 0) {
+		repeat = false;
+	}
+	key_status[code] = 0x80;
+	
+	uint8_t prev_shift = key_status[VK_SHIFT];
+	uint8_t prev_control = key_status[VK_CONTROL];
+	uint8_t prev_menu = key_status[VK_MENU];
+	
+	key_status[VK_SHIFT] = key_status[VK_LSHIFT] | key_status[VK_RSHIFT];
+	key_status[VK_CONTROL] = key_status[VK_LCONTROL] | key_status[VK_RCONTROL];
+	key_status[VK_MENU] = key_status[VK_LMENU] | key_status[VK_RMENU];
+	
+	if(code == VK_LSHIFT || code == VK_RSHIFT) {
+		if(prev_shift == 0 && key_status[VK_SHIFT] != 0) {
+			vm->key_down(VK_SHIFT, repeat);
+		}
+	} else if(code == VK_LCONTROL|| code == VK_RCONTROL) {
+		if(prev_control == 0 && key_status[VK_CONTROL] != 0) {
+			vm->key_down(VK_CONTROL, repeat);
+		}
+	} else if(code == VK_LMENU|| code == VK_RMENU) {
+		if(prev_menu == 0 && key_status[VK_MENU] != 0) {
+			vm->key_down(VK_MENU, repeat);
+		}
+	}
+	vm->key_down(code, repeat);
+}
+
+void OSD::key_up_native(int code)
+{
+	if(key_status[code] == 0) {
+		return;
+	}
+	if((key_status[code] &= 0x7f) != 0) {
+		return;
+	}
+	vm->key_up(code);
+	
+	uint8_t prev_shift = key_status[VK_SHIFT];
+	uint8_t prev_control = key_status[VK_CONTROL];
+	uint8_t prev_menu = key_status[VK_MENU];
+	
+	key_status[VK_SHIFT] = key_status[VK_LSHIFT] | key_status[VK_RSHIFT];
+	key_status[VK_CONTROL] = key_status[VK_LCONTROL] | key_status[VK_RCONTROL];
+	key_status[VK_MENU] = key_status[VK_LMENU] | key_status[VK_RMENU];
+	
+	if(code == VK_LSHIFT || code == VK_RSHIFT) {
+		if(prev_shift != 0 && key_status[VK_SHIFT] == 0) {
+			vm->key_up(VK_SHIFT);
+		}
+	} else if(code == VK_LCONTROL|| code == VK_RCONTROL) {
+		if(prev_control != 0 && key_status[VK_CONTROL] == 0) {
+			vm->key_up(VK_CONTROL);
+		}
+	} else if(code == VK_LMENU || code == VK_RMENU) {
+		if(prev_menu != 0 && key_status[VK_MENU] == 0) {
+			vm->key_up(VK_MENU);
+		}
+	}
+}
+
+#ifdef USE_MOUSE
+void OSD::enable_mouse()
+{
+	mouse_enabled = true;
+}
+
+void OSD::disable_mouse()
+{
+	mouse_enabled = false;
+}
+
+void OSD::toggle_mouse()
+{
+	mouse_enabled = !mouse_enabled;
+}
+#endif
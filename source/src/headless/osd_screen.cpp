@@ -0,0 +1,293 @@
+/*
+	Skelton for retropc emulator
+
+	Author : Takeda.Toshiya
+	Date   : 2015.11.20-
+
+	[ headless screen ]
+*/
+
+#include "osd.h"
+#include "../fileio.h"
+
+void OSD::initialize_screen()
+{
+	vm_screen_width = SCREEN_WIDTH;
+	vm_screen_height = SCREEN_HEIGHT;
+	vm_window_width = WINDOW_WIDTH;
+	vm_window_height = WINDOW_HEIGHT;
+	vm_window_width_aspect = WINDOW_WIDTH_ASPECT;
+	vm_window_height_aspect = WINDOW_HEIGHT_ASPECT;
+	
+	memset(&vm_screen_buffer, 0, sizeof(bitmap_t));
+	initialize_screen_buffer(&vm_screen_buffer, vm_screen_width, vm_screen_height);
+	
+	now_record_video = false;
+#ifdef USE_SCREEN_FILTER
+	screen_skip_line = false;
+#endif
+}
+
+void OSD::release_screen()
+{
+	stop_record_video();
+	release_screen_buffer(&vm_screen_buffer);
+}
+
+double OSD::get_window_mode_power(int mode)
+{
+	if(mode + WINDOW_MODE_BASE == 2) {
+		return 1.5;
+	} else if(mode + WINDOW_MODE_BASE > 2) {
+		return mode + WINDOW_MODE_BASE - 1;
+	}
+	return mode + WINDOW_MODE_BASE;
+}
+
+int OSD::get_window_mode_width(int mode)
+{
+	return (int)((config.window_stretch_type == 0 ? vm_window_width : vm_window_width_aspect) * get_window_mode_power(mode));
+}
+
+int OSD::get_window_mode_height(int mode)
+{
+	return (int)((config.window_stretch_type == 0 ? vm_window_height : vm_window_height_aspect) * get_window_mode_power(mode));
+}
+
+void OSD::set_host_window_size(int window_width, int window_height, bool window_mode)
+{
+}
+
+void OSD::set_vm_screen_size(int screen_width, int screen_height, int window_width, int window_height, int window_width_aspect, int window_height_aspect)
+{
+	if(vm_screen_width != screen_width || vm_screen_height != screen_height) {
+		vm_screen_width = screen_width;
+		vm_screen_height = screen_height;
+		vm_window_width = (window_width == -1) ? screen_width : window_width;
+		vm_window_height = (window_height == -1) ? screen_height : window_height;
+		vm_window_width_aspect = (window_width_aspect == -1) ? vm_window_width : window_width_aspect;
+		vm_window_height_aspect = (window_height_aspect == -1) ? vm_window_height : window_height_aspect;
+	}
+	if(vm_screen_buffer.width != vm_screen_width || vm_screen_buffer.height != vm_screen_height) {
+		initialize_screen_buffer(&vm_screen_buffer, vm_screen_width, vm_screen_height);
+	}
+}
+
+void OSD::set_vm_screen_lines(int lines)
+{
+}
+
+scrntype_t* OSD::get_vm_screen_buffer(int y)
+{
+	return vm_screen_buffer.get_buffer(y);
+}
+
+int OSD::draw_screen()
+{
+	// draw screen
+	if(vm_screen_buffer.width != vm_screen_width || vm_screen_buffer.height != vm_screen_height) {
+		initialize_screen_buffer(&vm_screen_buffer, vm_screen_width, vm_screen_height);
+	}
+#ifdef USE_SCREEN_FILTER
+	screen_skip_line = false;
+#endif
+	vm->draw_screen();
+	return 1;
+}
+
+void OSD::initialize_screen_buffer(bitmap_t *buffer, int width, int height)
+{
+	release_screen_buffer(buffer);
+	buffer->width = width;
+	buffer->height = height;
+	buffer->lpBmp = (scrntype_t *)calloc(width * height, sizeof(scrntype_t));
+}
+
+void OSD::release_screen_buffer(bitmap_t *buffer)
+{
+	if(buffer->lpBmp != NULL) {
+		free(buffer->lpBmp);
+	}
+	memset(buffer, 0, sizeof(bitmap_t));
+}
+
+void OSD::capture_screen()
+{
+	write_bitmap_to_file(&vm_screen_buffer, create_date_file_path(_T("bmp")));
+}
+
+bool OSD::start_record_video(int fps)
+{
+	// video recording is not supported
+	return false;
+}
+
+void OSD::stop_record_video()
+{
+	now_record_video = false;
+}
+
+void OSD::restart_record_video()
+{
+}
+
+void OSD::add_extra_frames(int extra_frames)
+{
+}
+
+#ifdef USE_PRINTER
+void OSD::create_bitmap(bitmap_t *bitmap, int width, int height)
+{
+	memset(bitmap, 0, sizeof(bitmap_t));
+	initialize_screen_buffer(bitmap, width, height);
+}
+
+void OSD::release_bitmap(bitmap_t *bitmap)
+{
+	release_screen_buffer(bitmap);
+}
+
+void OSD::create_font(font_t *font, const _TCHAR *family, int width, int height, int rotate, bool bold, bool italic)
+{
+	my_tcscpy_s(font->family, 64, family);
+	font->width = width;
+	font->height = height;
+	font->rotate = rotate;
+	font->bold = bold;
+	font->italic = italic;
+}
+
+void OSD::release_font(font_t *font)
+{
+	font->family[0] = _T('\0');
+}
+
+void OSD::create_pen(pen_t *pen, int width, uint8_t r, uint8_t g, uint8_t b)
+{
+	pen->width = width;
+	pen->r = r;
+	pen->g = g;
+	pen->b = b;
+}
+
+void OSD::release_pen(pen_t *pen)
+{
+	pen->width = 0;
+}
+
+void OSD::clear_bitmap(bitmap_t *bitmap, uint8_t r, uint8_t g, uint8_t b)
+{
+	draw_rectangle_to_bitmap(bitmap, 0, 0, bitmap->width, bitmap->height, r, g, b);
+}
+
+int OSD::get_text_width(bitmap_t *bitmap, font_t *font, const char *text)
+{
+	// no font rasterizer, assume a fixed pitch font
+	return font->width * (int)strlen(text);
+}
+
+void OSD::draw_text_to_bitmap(bitmap_t *bitmap, font_t *font, int x, int y, const char *text, uint8_t r, uint8_t g, uint8_t b)
+{
+	// no font rasterizer
+}
+
+void OSD::draw_line_to_bitmap(bitmap_t *bitmap, pen_t *pen, int sx, int sy, int ex, int ey)
+{
+	int dx = abs(ex - sx), dy = abs(ey - sy);
+	int steps = max(dx, dy);
+	
+	for(int i = 0; i <= steps; i++) {
+		int x = sx + (steps ? (ex - sx) * i / steps : 0);
+		int y = sy + (steps ? (ey - sy) * i / steps : 0);
+		draw_rectangle_to_bitmap(bitmap, x, y, max(pen->width, 1), max(pen->width, 1), pen->r, pen->g, pen->b);
+	}
+}
+
+void OSD::draw_rectangle_to_bitmap(bitmap_t *bitmap, int x, int y, int width, int height, uint8_t r, uint8_t g, uint8_t b)
+{
+	scrntype_t col = RGB_COLOR(r, g, b);
+	
+	for(int py = max(y, 0); py < min(y + height, bitmap->height); py++) {
+		scrntype_t *dest = bitmap->get_buffer(py);
+		for(int px = max(x, 0); px < min(x + width, bitmap->width); px++) {
+			dest[px] = col;
+		}
+	}
+}
+
+void OSD::draw_point_to_bitmap(bitmap_t *bitmap, int x, int y, uint8_t r, uint8_t g, uint8_t b)
+{
+	if(x >= 0 && x < bitmap->width && y >= 0 && y < bitmap->height) {
+		bitmap->get_buffer(y)[x] = RGB_COLOR(r, g, b);
+	}
+}
+
+void OSD::stretch_bitmap(bitmap_t *dest, int dest_x, int dest_y, int dest_width, int dest_height, bitmap_t *source, int source_x, int source_y, int source_width, int source_height)
+{
+	for(int y = 0; y < dest_height; y++) {
+		int dy = dest_y + y, sy = source_y + y * source_height / dest_height;
+		if(dy < 0 || dy >= dest->height || sy < 0 || sy >= source->height) {
+			continue;
+		}
+		scrntype_t *d = dest->get_buffer(dy);
+		scrntype_t *s = source->get_buffer(sy);
+		for(int x = 0; x < dest_width; x++) {
+			int dx = dest_x + x, sx = source_x + x * source_width / dest_width;
+			if(dx >= 0 && dx < dest->width && sx >= 0 && sx < source->width) {
+				d[dx] = s[sx];
+			}
+		}
+	}
+}
+#endif
+
+void OSD::write_bitmap_to_file(bitmap_t *bitmap, const _TCHAR *file_path)
+{
+	// save as 24bit bmp file
+	FILEIO* fio = new FILEIO();
+	
+	if(fio->Fopen(file_path, FILEIO_WRITE_BINARY)) {
+		int line_size = (bitmap->width * 3 + 3) & ~3;
+		uint32_t image_size = line_size * bitmap->height;
+		
+		fio->FputUint8('B');
+		fio->FputUint8('M');
+		fio->FputUint32_LE(14 + 40 + image_size);	// bfSize
+		fio->FputUint32_LE(0);				// bfReserved1,2
+		fio->FputUint32_LE(14 + 40);			// bfOffBits
+		fio->FputUint32_LE(40);				// biSize
+		fio->FputInt32_LE(bitmap->width);		// biWidth
+		fio->FputInt32_LE(bitmap->height);		// biHeight
+		fio->FputUint16_LE(1);				// biPlanes
+		fio->FputUint16_LE(24);				// biBitCount
+		fio->FputUint32_LE(0);				// biCompression
+		fio->FputUint32_LE(image_size);			// biSizeImage
+		fio->FputUint32_LE(0);				// biXPelsPerMeter
+		fio->FputUint32_LE(0);				// biYPelsPerMeter
+		fio->FputUint32_LE(0);				// biClrUsed
+		fio->FputUint32_LE(0);				// biClrImportant
+		
+		uint8_t *line = (uint8_t *)calloc(line_size, 1);
+		for(int y = bitmap->height - 1; y >= 0; y--) {
+			scrntype_t *src = bitmap->get_buffer(y);
+			for(int x = 0; x < bitmap->width; x++) {
+				line[x * 3 + 0] = B_OF_COLOR(src[x]);
+				line[x * 3 + 1] = G_OF_COLOR(src[x]);
+				line[x * 3 + 2] = R_OF_COLOR(src[x]);
+			}
+			fio->Fwrite(line, line_size, 1);
+		}
+		free(line);
+		fio->Fclose();
+	}
+	delete fio;
+}
+
+bool OSD::write_screen_to_file(const _TCHAR *file_path)
+{
+	if(!vm_screen_buffer.initialized()) {
+		return false;
+	}
+	write_bitmap_to_file(&vm_screen_buffer, file_path);
+	return true;
+}
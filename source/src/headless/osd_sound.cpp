@@ -0,0 +1,111 @@
+/*
+	Skelton for retropc emulator
+
+	Author : Takeda.Toshiya
+	Date   : 2015.11.26-
+
+	[ headless sound ]
+*/
+
+#include "osd.h"
+
+void OSD::initialize_sound(int rate, int samples)
+{
+	sound_rate = rate;
+	sound_samples = samples;
+	sound_available = true;
+	sound_muted = now_record_sound = false;
+	rec_sound_buffer_ptr = 0;
+	
+	// keep 8 buffers (stereo samples)
+	sound_ring.initialize(samples * 8);
+	
+	// start the thread to write files
+	sound_writer.initialize();
+}
+
+void OSD::release_sound()
+{
+	// stop recording
+	stop_record_sound();
+	
+	// release ring buffer
+	sound_ring.release();
+	
+	// close the rest of files
+	sound_writer.release();
+}
+
+void OSD::update_sound(int* extra_frames)
+{
+	*extra_frames = 0;
+	sound_muted = false;
+	
+	if(sound_available) {
+		// there is no host device to pace us, so flush the buffer as soon as
+		// it is filled (the mixing buffer has room for one more buffer)
+		if(vm->get_sound_buffer_ptr() < sound_samples) {
+			return;
+		}
+		
+		// sound buffer must be updated
+		uint16_t* sound_buffer = vm->create_sound(extra_frames);
+		if(now_record_sound) {
+			// record sound
+			if(sound_samples > rec_sound_buffer_ptr) {
+				int samples = sound_samples - rec_sound_buffer_ptr;
+				sound_writer.write(rec_sound_id, (int16_t *)(sound_buffer + rec_sound_buffer_ptr * 2), samples);
+			}
+			rec_sound_buffer_ptr = 0;
+		}
+		sound_ring.write((int16_t *)sound_buffer, sound_samples);
+	}
+}
+
+void OSD::mute_sound()
+{
+	sound_muted = true;
+}
+
+void OSD::stop_sound()
+{
+}
+
+void OSD::start_record_sound()
+{
+	create_date_file_path(sound_file_path, _MAX_PATH, _T("wav"));
+	start_record_sound(sound_file_path);
+}
+
+bool OSD::start_record_sound(const _TCHAR *file_path)
+{
+	if(!now_record_sound) {
+		// create wave file
+		if(file_path != sound_file_path) {
+			my_tcscpy_s(sound_file_path, _MAX_PATH, file_path);
+		}
+		if((rec_sound_id = sound_writer.open(sound_file_path, sound_rate, true)) != -1) {
+			rec_sound_buffer_ptr = vm->get_sound_buffer_ptr();
+			now_record_sound = true;
+		}
+	}
+	return now_record_sound;
+}
+
+void OSD::stop_record_sound()
+{
+	if(now_record_sound) {
+		// the wave header is updated by the thread
+		sound_writer.close(rec_sound_id);
+		now_record_sound = false;
+	}
+}
+
+void OSD::restart_record_sound()
+{
+	bool tmp = now_record_sound;
+	stop_record_sound();
+	if(tmp) {
+		start_record_sound();
+	}
+}
@@ -115,6 +115,7 @@
 #define ID_CPU_POWER3                   40014
 #define ID_CPU_POWER4                   40015
 #define ID_FULL_SPEED                   40016
+#define ID_TAPE_TURBO                   40017
 #define ID_AUTOKEY_START                40021
 #define ID_AUTOKEY_STOP                 40022
 #define ID_ROMAJI_TO_KANA               40023
@@ -294,7 +295,8 @@
 #define ID_VM_MONITOR_SCANLINE          41139
 #define ID_VM_MONITOR_SCANLINE_AUTO     41140
 #define ID_VM_MONITOR_COLOR_BLENDER     41141
-#define ID_VM_MONITOR_MENU_END          41141
+#define ID_VM_MONITOR_ACCURATE_RASTER   41142
+#define ID_VM_MONITOR_MENU_END          41142
 
 #define ID_VM_PRINTER_MENU_START        41150
 #define ID_VM_PRINTER_TYPE0             41151
@@ -362,7 +364,8 @@
 #define ID_SOUND_STRICT_RENDER          41521
 #define ID_SOUND_LIGHT_RENDER           41522
 #define ID_SOUND_VOLUME                 41523
-#define ID_SOUND_MENU_END               41523
+#define ID_SOUND_BAND_LIMITED           41524
+#define ID_SOUND_MENU_END               41524
 
 #define ID_INPUT_MENU_START             41601
 #define ID_INPUT_JOYSTICK0              41601
@@ -0,0 +1,171 @@
+/*
+	Skelton for retropc emulator
+
+	Date   : 2026.10.17-
+
+	[ lock-free sound ring buffer ]
+*/
+
+#include <stdlib.h>
+#include "sound_ring.h"
+
+SOUND_RING::SOUND_RING()
+{
+	buffer = NULL;
+	mask = 0;
+	capacity = 0;
+	clear();
+}
+
+SOUND_RING::~SOUND_RING()
+{
+	release();
+}
+
+void SOUND_RING::initialize(int samples)
+{
+	release();
+
+	// the buffer is power of 2 to wrap the free running positions
+	uint32_t size = 1;
+	while(size < (uint32_t)samples) {
+		size <<= 1;
+	}
+	buffer = (int16_t *)calloc(size * 2, sizeof(int16_t));
+	mask = size - 1;
+	capacity = samples;
+	clear();
+}
+
+void SOUND_RING::release()
+{
+	if(buffer != NULL) {
+		free(buffer);
+		buffer = NULL;
+	}
+	capacity = 0;
+}
+
+void SOUND_RING::clear()
+{
+	write_ptr.store(0);
+	read_ptr.store(0);
+	underrun_samples.store(0);
+	overrun_samples = 0;
+	ratio = 1.0;
+	phase = 0.0;
+	last_l = last_r = 0;
+	hold_l = hold_r = 0;
+	primed = false;
+}
+
+int SOUND_RING::write(const int16_t* data, int samples)
+{
+	uint32_t wpt = write_ptr.load(std::memory_order_relaxed);
+	int space = capacity - (int)(wpt - read_ptr.load(std::memory_order_acquire));
+
+	if(samples > space) {
+		// the newest samples are dropped, the consumer owns the read position
+		overrun_samples += samples - space;
+		samples = space;
+	}
+	int offset = wpt & mask;
+	int count = min(samples, (int)(mask + 1) - offset);
+	memcpy(buffer + offset * 2, data, count * sizeof(int16_t) * 2);
+	if(count < samples) {
+		memcpy(buffer, data + count * 2, (samples - count) * sizeof(int16_t) * 2);
+	}
+	write_ptr.store(wpt + samples, std::memory_order_release);
+	return samples;
+}
+
+int SOUND_RING::write_with_rate_control(const int16_t* data, int samples)
+{
+	// stretch or shrink the samples a little to keep the ring half filled,
+	// instead of driving the extra frames when the host device runs faster
+	// the count at the middle of this write is compared, the count before
+	// the write is the bottom of sawtooth because the samples come by blocks
+	int half = capacity / 2;
+	if(half == 0) {
+		return write(data, samples);
+	}
+	ratio = 1.0 + SOUND_RING_RATE_CONTROL * (half - get_count() - samples / 2) / half;
+	if(ratio > 1.0 + SOUND_RING_RATE_CONTROL) {
+		ratio = 1.0 + SOUND_RING_RATE_CONTROL;
+	} else if(ratio < 1.0 - SOUND_RING_RATE_CONTROL) {
+		ratio = 1.0 - SOUND_RING_RATE_CONTROL;
+	}
+	double step = 1.0 / ratio;
+	int16_t tmp[256 * 2];
+	int count = 0, written = 0;
+
+	for(int i = 0; i < samples; i++) {
+		int16_t l = data[i * 2 + 0];
+		int16_t r = data[i * 2 + 1];
+		// interpolate between the previous sample and this sample
+		for(; phase < 1.0; phase += step) {
+			tmp[count * 2 + 0] = (int16_t)(last_l + (l - last_l) * phase);
+			tmp[count * 2 + 1] = (int16_t)(last_r + (r - last_r) * phase);
+			if(++count == 256) {
+				written += write(tmp, count);
+				count = 0;
+			}
+		}
+		phase -= 1.0;
+		last_l = l;
+		last_r = r;
+	}
+	if(count > 0) {
+		written += write(tmp, count);
+	}
+	return written;
+}
+
+int SOUND_RING::read(int16_t* data, int samples)
+{
+	uint32_t rpt = read_ptr.load(std::memory_order_relaxed);
+	int count = (int)(write_ptr.load(std::memory_order_acquire) - rpt);
+
+	if(samples > count) {
+		samples = count;
+	}
+	int offset = rpt & mask;
+	count = min(samples, (int)(mask + 1) - offset);
+	memcpy(data, buffer + offset * 2, count * sizeof(int16_t) * 2);
+	if(count < samples) {
+		memcpy(data + count * 2, buffer, (samples - count) * sizeof(int16_t) * 2);
+	}
+	read_ptr.store(rpt + samples, std::memory_order_release);
+	return samples;
+}
+
+void SOUND_RING::read_with_padding(int16_t* data, int samples)
+{
+	// wait until the ring is half filled at first and after the underrun,
+	// not to underrun again soon
+	if(!primed) {
+		if(get_count() < capacity / 2) {
+			for(int i = 0; i < samples; i++) {
+				data[i * 2 + 0] = hold_l;
+				data[i * 2 + 1] = hold_r;
+			}
+			return;
+		}
+		primed = true;
+	}
+	int count = read(data, samples);
+
+	if(count > 0) {
+		hold_l = data[count * 2 - 2];
+		hold_r = data[count * 2 - 1];
+	}
+	if(count < samples) {
+		// hold the last sample not to make a click
+		for(int i = count; i < samples; i++) {
+			data[i * 2 + 0] = hold_l;
+			data[i * 2 + 1] = hold_r;
+		}
+		underrun_samples.fetch_add(samples - count, std::memory_order_relaxed);
+		primed = false;
+	}
+}
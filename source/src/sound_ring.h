@@ -0,0 +1,79 @@
+/*
+	Skelton for retropc emulator
+
+	Date   : 2026.10.17-
+
+	[ lock-free sound ring buffer ]
+*/
+
+#ifndef _SOUND_RING_H_
+#define _SOUND_RING_H_
+
+#include "common.h"
+#include <atomic>
+
+// maximum adjustment of the resampling ratio by the rate control
+#define SOUND_RING_RATE_CONTROL	0.005
+
+// stereo 16bit samples passed from one producer (the emulation thread that
+// creates the sound) to one consumer (the thread of the host audio device)
+class DLL_PREFIX SOUND_RING
+{
+private:
+	int16_t* buffer;
+	uint32_t mask;
+	int capacity;
+
+	// free running positions, the count is write_ptr - read_ptr
+	std::atomic<uint32_t> write_ptr, read_ptr;
+	std::atomic<uint32_t> underrun_samples;
+	uint32_t overrun_samples;
+
+	// producer : linear resampler of the rate control
+	double ratio, phase;
+	int16_t last_l, last_r;
+
+	// consumer : the last sample is held while the ring is empty
+	int16_t hold_l, hold_r;
+	bool primed;
+
+public:
+	SOUND_RING();
+	~SOUND_RING();
+	void initialize(int samples);
+	void release();
+	// only when the consumer is stopped
+	void clear();
+
+	int get_capacity()
+	{
+		return capacity;
+	}
+	int get_count()
+	{
+		return (int)(write_ptr.load(std::memory_order_acquire) - read_ptr.load(std::memory_order_acquire));
+	}
+
+	// producer
+	int write(const int16_t* data, int samples);
+	int write_with_rate_control(const int16_t* data, int samples);
+	double get_ratio()
+	{
+		return ratio;
+	}
+	uint32_t get_overrun_samples()
+	{
+		return overrun_samples;
+	}
+
+	// consumer
+	int read(int16_t* data, int samples);
+	void read_with_padding(int16_t* data, int samples);
+	uint32_t get_underrun_samples()
+	{
+		return underrun_samples.load(std::memory_order_relaxed);
+	}
+};
+
+#endif
+
@@ -0,0 +1,299 @@
+/*
+	Skelton for retropc emulator
+
+	Date   : 2026.10.17-
+
+	[ sound file writer ]
+*/
+
+#include "sound_writer.h"
+#include "fileio.h"
+
+static void sleep_msec(int msec)
+{
+#ifdef _WIN32
+	Sleep(msec);
+#else
+	usleep(msec * 1000);
+#endif
+}
+
+#ifdef _MSC_VER
+unsigned __stdcall sound_writer_thread(void *lpx)
+#else
+void* sound_writer_thread(void *lpx)
+#endif
+{
+	SOUND_WRITER *writer = (SOUND_WRITER *)lpx;
+
+	while(writer->flush()) {
+		sleep_msec(10);
+	}
+#ifdef _MSC_VER
+	_endthreadex(0);
+	return 0;
+#else
+	pthread_exit(NULL);
+	return NULL;
+#endif
+}
+
+SOUND_WRITER::SOUND_WRITER()
+{
+	memset(streams, 0, sizeof(streams));
+	queue = NULL;
+	queue_read_ptr = queue_count = 0;
+	wait_count = 0;
+	initialized = request_terminate = false;
+}
+
+SOUND_WRITER::~SOUND_WRITER()
+{
+	release();
+}
+
+void SOUND_WRITER::initialize()
+{
+	if(!initialized) {
+		queue = (block_t *)malloc(sizeof(block_t) * SOUND_WRITER_QUEUE);
+		queue_read_ptr = queue_count = 0;
+		wait_count = 0;
+		request_terminate = false;
+#ifdef _MSC_VER
+		InitializeCriticalSection(&lock);
+		hThread = (HANDLE)_beginthreadex(NULL, 0, sound_writer_thread, this, 0, NULL);
+#else
+		pthread_mutex_init(&lock, NULL);
+		pthread_create(&thread_id, NULL, sound_writer_thread, this);
+#endif
+		initialized = true;
+	}
+}
+
+void SOUND_WRITER::release()
+{
+	if(initialized) {
+		// close all files, and stop the thread after the queued blocks are written
+		for(int i = 0; i < SOUND_WRITER_STREAMS; i++) {
+			if(is_opened(i)) {
+				close(i);
+			}
+		}
+		enter_lock();
+		request_terminate = true;
+		leave_lock();
+#ifdef _MSC_VER
+		WaitForSingleObject(hThread, INFINITE);
+		CloseHandle(hThread);
+#else
+		pthread_join(thread_id, NULL);
+#endif
+		flush();
+
+		free(queue);
+		queue = NULL;
+#ifdef _MSC_VER
+		DeleteCriticalSection(&lock);
+#else
+		pthread_mutex_destroy(&lock);
+#endif
+		initialized = false;
+	}
+}
+
+void SOUND_WRITER::enter_lock()
+{
+#ifdef _MSC_VER
+	EnterCriticalSection(&lock);
+#else
+	pthread_mutex_lock(&lock);
+#endif
+}
+
+void SOUND_WRITER::leave_lock()
+{
+#ifdef _MSC_VER
+	LeaveCriticalSection(&lock);
+#else
+	pthread_mutex_unlock(&lock);
+#endif
+}
+
+int SOUND_WRITER::open(const _TCHAR* file_path, int rate, bool wav)
+{
+	if(!initialized) {
+		return -1;
+	}
+	// the stream is free after the thread closed its previous file
+	int id = -1;
+	enter_lock();
+	for(int i = 0; i < SOUND_WRITER_STREAMS; i++) {
+		if(!streams[i].in_use) {
+			id = i;
+			break;
+		}
+	}
+	leave_lock();
+	if(id == -1) {
+		return -1;
+	}
+	stream_t *stream = &streams[id];
+	stream->fio = new FILEIO();
+	if(!stream->fio->Fopen(file_path, FILEIO_WRITE_BINARY)) {
+		delete stream->fio;
+		stream->fio = NULL;
+		return -1;
+	}
+	if(wav) {
+		// write dummy wave header, it is updated when the file is closed
+		wav_header_t wav_header;
+		wav_chunk_t wav_chunk;
+		memset(&wav_header, 0, sizeof(wav_header));
+		memset(&wav_chunk, 0, sizeof(wav_chunk));
+		stream->fio->Fwrite(&wav_header, sizeof(wav_header), 1);
+		stream->fio->Fwrite(&wav_chunk, sizeof(wav_chunk), 1);
+	}
+	my_tcscpy_s(stream->path, _MAX_PATH, file_path);
+	stream->wav = wav;
+	stream->rate = rate;
+	stream->bytes = 0;
+	stream->pending = (int16_t *)malloc(SOUND_WRITER_BLOCK * sizeof(int16_t) * 2);
+	stream->pending_samples = 0;
+
+	enter_lock();
+	stream->in_use = true;
+	leave_lock();
+	return id;
+}
+
+void SOUND_WRITER::write(int id, const int16_t* data, int samples)
+{
+	if(!is_opened(id)) {
+		return;
+	}
+	stream_t *stream = &streams[id];
+	while(samples > 0) {
+		int count = min(samples, SOUND_WRITER_BLOCK - stream->pending_samples);
+		memcpy(stream->pending + stream->pending_samples * 2, data, count * sizeof(int16_t) * 2);
+		stream->pending_samples += count;
+		data += count * 2;
+		samples -= count;
+		if(stream->pending_samples == SOUND_WRITER_BLOCK) {
+			enqueue(id, stream->pending, SOUND_WRITER_BLOCK, false);
+			stream->pending_samples = 0;
+		}
+	}
+}
+
+void SOUND_WRITER::close(int id)
+{
+	if(!is_opened(id)) {
+		return;
+	}
+	stream_t *stream = &streams[id];
+	enqueue(id, stream->pending, stream->pending_samples, true);
+	free(stream->pending);
+	stream->pending = NULL;
+	stream->pending_samples = 0;
+}
+
+void SOUND_WRITER::enqueue(int id, const int16_t* data, int samples, bool close)
+{
+	// wait for the thread when the disk is too slow, not to lose the sound
+	int ptr;
+	enter_lock();
+	while(queue_count == SOUND_WRITER_QUEUE) {
+		leave_lock();
+		wait_count++;
+		sleep_msec(1);
+		enter_lock();
+	}
+	ptr = (queue_read_ptr + queue_count) % SOUND_WRITER_QUEUE;
+	leave_lock();
+
+	// the thread does not touch the free block until it is counted
+	block_t *block = &queue[ptr];
+	block->id = id;
+	block->samples = samples;
+	block->close = close;
+	memcpy(block->data, data, samples * sizeof(int16_t) * 2);
+
+	enter_lock();
+	queue_count++;
+	leave_lock();
+}
+
+bool SOUND_WRITER::flush()
+{
+	// write the queued blocks without the lock
+	enter_lock();
+	int count = queue_count;
+	int ptr = queue_read_ptr;
+	bool terminate = request_terminate;
+	leave_lock();
+
+	for(int i = 0; i < count; i++) {
+		write_block(&queue[(ptr + i) % SOUND_WRITER_QUEUE]);
+	}
+	if(count != 0) {
+		enter_lock();
+		queue_read_ptr = (queue_read_ptr + count) % SOUND_WRITER_QUEUE;
+		queue_count -= count;
+		leave_lock();
+	}
+	return !terminate;
+}
+
+void SOUND_WRITER::write_block(block_t* block)
+{
+	stream_t *stream = &streams[block->id];
+	if(block->samples != 0) {
+		int length = block->samples * sizeof(int16_t) * 2; // stereo
+		stream->fio->Fwrite(block->data, length, 1);
+		stream->bytes += length;
+	}
+	if(block->close) {
+		close_file(stream);
+		enter_lock();
+		stream->in_use = false;
+		leave_lock();
+	}
+}
+
+void SOUND_WRITER::close_file(stream_t* stream)
+{
+	if(stream->wav) {
+		if(stream->bytes == 0) {
+			stream->fio->Fclose();
+			FILEIO::RemoveFile(stream->path);
+		} else {
+			// update wave header
+			wav_header_t wav_header;
+			wav_chunk_t wav_chunk;
+
+			memcpy(wav_header.riff_chunk.id, "RIFF", 4);
+			wav_header.riff_chunk.size = stream->bytes + sizeof(wav_header) + sizeof(wav_chunk) - 8;
+			memcpy(wav_header.wave, "WAVE", 4);
+			memcpy(wav_header.fmt_chunk.id, "fmt ", 4);
+			wav_header.fmt_chunk.size = 16;
+			wav_header.format_id = 1;
+			wav_header.channels = 2;
+			wav_header.sample_bits = 16;
+			wav_header.sample_rate = stream->rate;
+			wav_header.block_size = wav_header.channels * wav_header.sample_bits / 8;
+			wav_header.data_speed = wav_header.sample_rate * wav_header.block_size;
+
+			memcpy(wav_chunk.id, "data", 4);
+			wav_chunk.size = stream->bytes;
+
+			stream->fio->Fseek(0, FILEIO_SEEK_SET);
+			stream->fio->Fwrite(&wav_header, sizeof(wav_header), 1);
+			stream->fio->Fwrite(&wav_chunk, sizeof(wav_chunk), 1);
+			stream->fio->Fclose();
+		}
+	} else {
+		stream->fio->Fclose();
+	}
+	delete stream->fio;
+	stream->fio = NULL;
+}
@@ -0,0 +1,96 @@
+/*
+	Skelton for retropc emulator
+
+	Date   : 2026.10.17-
+
+	[ sound file writer ]
+*/
+
+#ifndef _SOUND_WRITER_H_
+#define _SOUND_WRITER_H_
+
+#include "common.h"
+#ifndef _MSC_VER
+#include <pthread.h>
+#endif
+
+class FILEIO;
+
+// files written at once (the recorded sound and the stems of sound devices)
+#define SOUND_WRITER_STREAMS	40
+// blocks queued to the thread, the producer waits when all blocks are queued
+#define SOUND_WRITER_QUEUE	64
+// stereo samples in a block
+#define SOUND_WRITER_BLOCK	4096
+
+// the samples are collected into blocks on the emulation thread,
+// and the blocks are written to files by the background thread
+class DLL_PREFIX SOUND_WRITER
+{
+private:
+	typedef struct {
+		// used by the thread
+		FILEIO* fio;
+		_TCHAR path[_MAX_PATH];
+		bool wav;
+		int rate;
+		uint32_t bytes;
+		// used by the producer
+		int16_t* pending;
+		int pending_samples;
+		// cleared by the thread after the file is closed
+		bool in_use;
+	} stream_t;
+	stream_t streams[SOUND_WRITER_STREAMS];
+
+	typedef struct {
+		int id;
+		int samples;
+		bool close;
+		int16_t data[SOUND_WRITER_BLOCK * 2];
+	} block_t;
+	block_t* queue;
+	int queue_read_ptr, queue_count;
+	uint32_t wait_count;
+
+	bool initialized;
+	bool request_terminate;
+#ifdef _MSC_VER
+	HANDLE hThread;
+	CRITICAL_SECTION lock;
+#else
+	pthread_t thread_id;
+	pthread_mutex_t lock;
+#endif
+	void enter_lock();
+	void leave_lock();
+	void enqueue(int id, const int16_t* data, int samples, bool close);
+	void write_block(block_t* block);
+	void close_file(stream_t* stream);
+
+public:
+	SOUND_WRITER();
+	~SOUND_WRITER();
+	void initialize();
+	void release();
+
+	// producer (one thread)
+	int open(const _TCHAR* file_path, int rate, bool wav);
+	void write(int id, const int16_t* data, int samples);
+	void close(int id);
+	bool is_opened(int id)
+	{
+		return (id >= 0 && id < SOUND_WRITER_STREAMS && streams[id].pending != NULL);
+	}
+	// times the producer waited for the thread because the queue was full
+	uint32_t get_wait_count()
+	{
+		return wait_count;
+	}
+
+	// called by the thread
+	bool flush();
+};
+
+#endif
+
@@ -0,0 +1,111 @@
+/*
+	Skelton for retropc emulator
+
+	Date   : 2026.10.17-
+
+	[ band-limited step synthesizer ]
+*/
+
+#ifndef _BLEP_H_
+#define _BLEP_H_
+
+#include "../common.h"
+#include "../fileio.h"
+
+// the step is inserted at 1/BLEP_PHASES sample resolution and spread over
+// BLEP_TAPS samples, so the output is delayed by BLEP_TAPS/2 samples
+#define BLEP_PHASES	32
+#define BLEP_TAPS	16
+// samples generated at once, the caller splits the longer mix() into blocks
+#define BLEP_BLOCK	256
+
+#define BLEP_PI		3.14159265358979323846
+
+class BLEP
+{
+private:
+	int16_t kernel[BLEP_PHASES][BLEP_TAPS];
+	int32_t delta[BLEP_BLOCK + BLEP_TAPS];
+	int32_t accum;
+
+public:
+	BLEP()
+	{
+		initialize();
+		clear();
+	}
+	~BLEP() {}
+
+	// windowed sinc impulses, the sum of each phase is 32768 exactly
+	// then the integrated step settles to the level without any drift
+	void initialize()
+	{
+		const double cutoff = 0.85;	// of nyquist
+		for(int p = 0; p < BLEP_PHASES; p++) {
+			double frac = (p + 0.5) / BLEP_PHASES;
+			double tap[BLEP_TAPS], sum = 0;
+			for(int k = 0; k < BLEP_TAPS; k++) {
+				double x = k - (BLEP_TAPS / 2 - 1) - frac;
+				double w = (x + BLEP_TAPS / 2) / BLEP_TAPS;
+				double sinc = (x == 0) ? 1.0 : sin(BLEP_PI * cutoff * x) / (BLEP_PI * cutoff * x);
+				tap[k] = cutoff * sinc * (0.42 - 0.5 * cos(2 * BLEP_PI * w) + 0.08 * cos(4 * BLEP_PI * w));
+				sum += tap[k];
+			}
+			int total = 0, peak = 0;
+			for(int k = 0; k < BLEP_TAPS; k++) {
+				kernel[p][k] = (int16_t)floor(tap[k] * 32768.0 / sum + 0.5);
+				total += kernel[p][k];
+				if(kernel[p][k] > kernel[p][peak]) {
+					peak = k;
+				}
+			}
+			kernel[p][peak] += 32768 - total;
+		}
+	}
+	void clear()
+	{
+		memset(delta, 0, sizeof(delta));
+		accum = 0;
+	}
+	bool is_idle()
+	{
+		if(accum) {
+			return false;
+		}
+		for(int i = 0; i < BLEP_TAPS; i++) {
+			if(delta[i]) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// step of the level at (sample + phase / BLEP_PHASES) in the block
+	inline void add_step(int sample, int phase, int32_t step)
+	{
+		const int16_t *k = kernel[phase];
+		int32_t *d = delta + sample;
+		for(int i = 0; i < BLEP_TAPS; i++) {
+			d[i] += step * k[i];
+		}
+	}
+	// integrate the steps to the levels of samples, and carry the tail
+	void read_samples(int32_t* buffer, int cnt)
+	{
+		for(int i = 0; i < cnt; i++) {
+			accum += delta[i];
+			buffer[i] = accum >> 15;
+		}
+		memmove(delta, delta + cnt, BLEP_TAPS * sizeof(int32_t));
+		memset(delta + BLEP_TAPS, 0, cnt * sizeof(int32_t));
+	}
+
+	void process_state(FILEIO* state_fio)
+	{
+		state_fio->StateArray(delta, sizeof(int32_t) * BLEP_TAPS, 1);
+		state_fio->StateValue(accum);
+	}
+};
+
+#endif
+
@@ -32,6 +32,8 @@ void DATAREC::initialize()
 	in_signal = out_signal = false;
 	register_id = -1;
 	realtime = false;
+	sample_loop_clock = sample_accum_clock = 0;
+	edge_samples = 0;
 	
 	buffer = buffer_bak = NULL;
 #ifdef DATAREC_SOUND
@@ -144,6 +146,11 @@ void DATAREC::event_frame()
 void DATAREC::event_callback(int event_id, int err)
 {
 	if(event_id == EVENT_SIGNAL) {
+		// one-shot event at the edge is fired
+		bool edge = (edge_samples != 0);
+		int skip = 0;
+		edge_samples = 0;
+		
 		if(play) {
 			if(ff_rew > 0) {
 				my_stprintf_s(message, 1024, _T("Fast Forward (%d %%)"), get_tape_position());
@@ -179,6 +186,13 @@ void DATAREC::event_callback(int event_id, int err)
 						signal = false;
 					}
 				}
+				if(edge && remote) {
+					// skip the samples with the same signal, the last sample is not skipped to stop at the end of tape
+					while(buffer_ptr + skip < buffer_length - 1 && ((buffer[buffer_ptr + skip] & 0x80) != 0) == signal) {
+						skip++;
+					}
+					buffer_ptr += skip;
+				}
 				update_event();
 			} else {
 				if(ff_rew < 0) {
@@ -201,6 +215,11 @@ void DATAREC::event_callback(int event_id, int err)
 								signal = ((buffer[buffer_ptr] & 0x80) != 0);
 								uint8_t tmp = buffer[buffer_ptr];
 								buffer[buffer_ptr] = (tmp & 0x80) | ((tmp & 0x7f) - 1);
+								if(edge) {
+									// skip the remaining length
+									skip = buffer[buffer_ptr] & 0x7f;
+									buffer[buffer_ptr] &= 0x80;
+								}
 								break;
 							}
 						}
@@ -226,35 +245,15 @@ void DATAREC::event_callback(int event_id, int err)
 			}
 			// chek apss state
 			if(apss_buffer != NULL) {
-				int ptr = (apss_ptr++) % (sample_rate * 2);
-				if(apss_buffer[ptr]) {
-					apss_count--;
-				}
-				if(in_signal) {
-					apss_count++;
-				}
-				apss_buffer[ptr] = in_signal;
-				
-				if(apss_ptr >= sample_rate * 2) {
-					double rate = (double)apss_count / (double)(sample_rate * 2);
-					if(rate > 0.9 || rate < 0.1) {
-						if(apss_signals) {
-							if(apss_remain > 0) {
-								apss_remain--;
-							} else if(apss_remain < 0) {
-								apss_remain++;
-							}
-							write_signals(&outputs_apss, 0xffffffff);
-							apss_signals = false;
-						}
-					} else {
-						if(!apss_signals) {
-							write_signals(&outputs_apss, 0);
-							apss_signals = true;
-						}
-					}
+				for(int i = 0; i <= skip; i++) {
+					update_apss();
 				}
 			}
+			if(edge && remote) {
+				// the event was already fired
+				register_id = -1;
+				register_signal_event(1 + skip);
+			}
 		} else if(rec && buffer != NULL) {
 			if(out_signal) {
 				positive_clocks += get_passed_clock(prev_clock);
@@ -315,6 +314,38 @@ void DATAREC::event_callback(int event_id, int err)
 	}
 }
 
+void DATAREC::update_apss()
+{
+	int ptr = (apss_ptr++) % (sample_rate * 2);
+	if(apss_buffer[ptr]) {
+		apss_count--;
+	}
+	if(in_signal) {
+		apss_count++;
+	}
+	apss_buffer[ptr] = in_signal;
+	
+	if(apss_ptr >= sample_rate * 2) {
+		double rate = (double)apss_count / (double)(sample_rate * 2);
+		if(rate > 0.9 || rate < 0.1) {
+			if(apss_signals) {
+				if(apss_remain > 0) {
+					apss_remain--;
+				} else if(apss_remain < 0) {
+					apss_remain++;
+				}
+				write_signals(&outputs_apss, 0xffffffff);
+				apss_signals = false;
+			}
+		} else {
+			if(!apss_signals) {
+				write_signals(&outputs_apss, 0);
+				apss_signals = true;
+			}
+		}
+	}
+}
+
 void DATAREC::set_remote(bool value)
 {
 	if(remote != value) {
@@ -342,8 +373,7 @@ void DATAREC::set_ff_rew(int value)
 {
 	if(ff_rew != value) {
 		if(register_id != -1) {
-			cancel_event(this, register_id);
-			register_id = -1;
+			cancel_signal_event();
 		}
 		if(value != 0) {
 			if(d_noise_fast != NULL && remote) {
@@ -396,6 +426,34 @@ bool DATAREC::do_apss(int value)
 	return result;
 }
 
+void DATAREC::skip_to_next_gap()
+{
+	// move to the next silent gap (longer than 0.25sec) without playing,
+	// this is used when the blocks in the tape image are loaded directly
+	if(play && is_wav && buffer != NULL) {
+		int gap = sample_rate / 4, count = 0;
+		int ptr = buffer_ptr;
+		
+		// skip the current gap
+		while(ptr < buffer_length && !(buffer[ptr] & 0x80)) {
+			ptr++;
+		}
+		for(; ptr < buffer_length; ptr++) {
+			if(buffer[ptr] & 0x80) {
+				count = 0;
+			} else if(++count >= gap) {
+				ptr -= count - 1;
+				break;
+			}
+		}
+		buffer_ptr = min(ptr, buffer_length);
+		
+		if(!remote) {
+			my_stprintf_s(message, 1024, _T("Stop (%d %%)"), get_tape_position());
+		}
+	}
+}
+
 void DATAREC::update_event()
 {
 	if(remote && (play || rec)) {
@@ -408,15 +466,20 @@ void DATAREC::update_event()
 				if(rec) {
 					my_stprintf_s(message, 1024, _T("Record"));
 				}
-				register_event(this, EVENT_SIGNAL, sample_usec, true, &register_id);
+				if(is_edge_playable()) {
+					sample_loop_clock = (uint64_t)(1024.0 * (double)get_event_clocks() / 1000000.0 * sample_usec + 0.5);
+					sample_accum_clock = 0;
+					register_signal_event(1);
+				} else {
+					register_event(this, EVENT_SIGNAL, sample_usec, true, &register_id);
+				}
 			}
 			prev_clock = get_current_clock();
 			positive_clocks = negative_clocks = 0;
 		}
 	} else {
 		if(register_id != -1) {
-			cancel_event(this, register_id);
-			register_id = -1;
+			cancel_signal_event();
 			if(play) {
 				if(buffer_ptr >= buffer_length) {
 					my_stprintf_s(message, 1024, _T("Stop (End-of-Tape)"));
@@ -446,6 +509,44 @@ void DATAREC::update_event()
 	update_realtime_render();
 }
 
+bool DATAREC::is_edge_playable()
+{
+#ifdef DATAREC_SOUND
+	if(sound_buffer != NULL) {
+		return false;
+	}
+#endif
+	return (play && ff_rew == 0 && buffer != NULL);
+}
+
+void DATAREC::register_signal_event(int samples)
+{
+	// same clocks as the loop event fired in every sample
+	sample_accum_clock += sample_loop_clock * samples;
+	uint64_t clock = sample_accum_clock >> 10;
+	sample_accum_clock -= clock << 10;
+	register_event_by_clock(this, EVENT_SIGNAL, clock, false, &register_id);
+	edge_samples = samples;
+}
+
+void DATAREC::cancel_signal_event()
+{
+	if(edge_samples > 1 && sample_loop_clock != 0) {
+		// the skipped samples that are not passed yet are played again
+		int remain = (int)(((uint64_t)get_event_remaining_clock(register_id) << 10) / sample_loop_clock);
+		if((remain = min(remain, edge_samples - 1)) > 0) {
+			if(is_wav) {
+				buffer_ptr -= remain;
+			} else {
+				buffer[buffer_ptr] += remain;
+			}
+		}
+	}
+	cancel_event(this, register_id);
+	register_id = -1;
+	edge_samples = 0;
+}
+
 void DATAREC::update_realtime_render()
 {
 	bool value = (remote && (play || rec) && ff_rew == 0 && config.sound_play_tape);
@@ -1738,7 +1839,7 @@ void DATAREC::update_config()
 	update_realtime_render();
 }
 
-#define STATE_VERSION	8
+#define STATE_VERSION	9
 
 bool DATAREC::process_state(FILEIO* state_fio, bool loading)
 {
@@ -1797,6 +1898,9 @@ bool DATAREC::process_state(FILEIO* state_fio, bool loading)
 	state_fio->StateValue(negative_clocks);
 	state_fio->StateValue(signal_changed);
 	state_fio->StateValue(register_id);
+	state_fio->StateValue(sample_loop_clock);
+	state_fio->StateValue(sample_accum_clock);
+	state_fio->StateValue(edge_samples);
 	state_fio->StateValue(realtime);
 	state_fio->StateValue(sample_rate);
 	state_fio->StateValue(sample_usec);
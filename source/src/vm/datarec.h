@@ -66,6 +66,15 @@ private:
 	bool *apss_buffer;
 	int apss_ptr, apss_count, apss_remain;
 	bool apss_signals;
+	void update_apss();
+	
+	// while playing, the signal event is fired only at the edges of the signal,
+	// and the samples with the same signal are skipped at once
+	uint64_t sample_loop_clock, sample_accum_clock;
+	int edge_samples;
+	bool is_edge_playable();
+	void register_signal_event(int samples);
+	void cancel_signal_event();
 	
 	int pcm_changed;
 	uint32_t pcm_prev_clock;
@@ -229,6 +238,7 @@ public:
 	void set_remote(bool value);
 	void set_ff_rew(int value);
 	bool do_apss(int value);
+	void skip_to_next_gap();
 	double get_ave_hi_freq();
 	int drive_num;
 };
@@ -16,35 +16,118 @@
 
 #ifdef USE_DEBUGGER
 
-#define MAX_BREAK_POINTS	16
 #define MAX_COMMAND_LENGTH	1024
 #define MAX_COMMAND_HISTORY	32
 #define MAX_CPU_TRACE		1024
 
+// condition of breakpoint compiled into the postfix code
+#define MAX_BREAK_COND_CODE	128
+#define MAX_BREAK_COND_STACK	16
+#define MAX_BREAK_COND_REGS	8
+
+enum {
+	BREAK_COND_NUM = 0,	// push next code
+	BREAK_COND_REG,		// push register regs[next code]
+	BREAK_COND_MEM8,	// replace address with byte
+	BREAK_COND_MEM16,	// replace address with word
+	BREAK_COND_LNOT,
+	BREAK_COND_NOT,
+	BREAK_COND_NEG,
+	BREAK_COND_MUL,
+	BREAK_COND_DIV,
+	BREAK_COND_MOD,
+	BREAK_COND_ADD,
+	BREAK_COND_SUB,
+	BREAK_COND_SHL,
+	BREAK_COND_SHR,
+	BREAK_COND_LT,
+	BREAK_COND_LE,
+	BREAK_COND_GT,
+	BREAK_COND_GE,
+	BREAK_COND_EQ,
+	BREAK_COND_NE,
+	BREAK_COND_AND,
+	BREAK_COND_XOR,
+	BREAK_COND_OR,
+	BREAK_COND_LAND,
+	BREAK_COND_LOR,
+};
+
+typedef struct {
+	uint32_t code[MAX_BREAK_COND_CODE];
+	int length;
+	_TCHAR regs[MAX_BREAK_COND_REGS][8];
+	_TCHAR text[MAX_COMMAND_LENGTH + 1];
+} break_cond_t;
+
+typedef struct {
+	uint32_t addr, mask;
+	int status;	// 0 = none, 1 = enabled, other = disabled
+	bool check_point;
+	break_cond_t *cond;	// NULL = break always
+} break_point_entry_t;
+
+// the number of breakpoints is not limited, and the access is checked with
+// the flag map of 64K memory addresses or 256 i/o ports at first
 typedef struct {
-	struct {
-		uint32_t addr, mask;
-		int status;	// 0 = none, 1 = enabled, other = disabled
-		bool check_point;
-	} table[MAX_BREAK_POINTS], stored[MAX_BREAK_POINTS];
+	break_point_entry_t *table, *stored;
+	int count, size, stored_count, stored_size;
+	uint64_t *sorted;	// address << 32 | index of enabled entries in order
+	int sorted_count;
+	uint8_t flag;
 	bool hit, restart;
 	uint32_t hit_addr;
 } break_point_t;
 
+#define BREAK_FLAG_EXEC		0x01
+#define BREAK_FLAG_READ		0x02
+#define BREAK_FLAG_WRITE	0x04
+#define BREAK_FLAG_IN		0x01
+#define BREAK_FLAG_OUT		0x02
+
 class DEBUGGER : public DEVICE
 {
 private:
 	DEVICE *d_parent, *d_mem, *d_io;
 	DEBUGGER *d_child;
+	uint8_t mem_flags[0x10000];
+	uint8_t io_flags[0x100];
 	
+	bool hit_entry(break_point_t *bp, int index, uint32_t addr)
+	{
+		break_point_entry_t *entry = &bp->table[index];
+		if(entry->cond == NULL || eval_break_cond(entry->cond) != 0) {
+			bp->hit = now_suspended = true;
+			bp->hit_addr = addr;
+			bp->restart = entry->check_point;
+			return true;
+		}
+		return false;
+	}
+	bool hit_mem_break_point(break_point_t *bp, uint32_t addr)
+	{
+		// binary search the first entry of this address
+		int lo = 0, hi = bp->sorted_count;
+		while(lo < hi) {
+			int mid = (lo + hi) >> 1;
+			if((uint32_t)(bp->sorted[mid] >> 32) < addr) {
+				lo = mid + 1;
+			} else {
+				hi = mid;
+			}
+		}
+		for(; lo < bp->sorted_count && (uint32_t)(bp->sorted[lo] >> 32) == addr; lo++) {
+			if(hit_entry(bp, (int)(bp->sorted[lo] & 0xffffffff), addr)) {
+				return true;
+			}
+		}
+		return false;
+	}
 	void check_mem_break_points(break_point_t *bp, uint32_t addr, int length)
 	{
-		for(int i = 0; i < MAX_BREAK_POINTS; i++) {
-			if(bp->table[i].status == 1) {
-				if(addr >= bp->table[i].addr && addr < bp->table[i].addr + length) {
-					bp->hit = now_suspended = true;
-					bp->hit_addr = bp->table[i].addr;
-					bp->restart = bp->table[i].check_point;
+		for(int i = 0; i < length; i++) {
+			if(mem_flags[(addr + i) & 0xffff] & bp->flag) {
+				if(hit_mem_break_point(bp, addr + i)) {
 					break;
 				}
 			}
@@ -58,13 +141,13 @@ private:
 	}
 	void check_io_break_points(break_point_t *bp, uint32_t addr)
 	{
-		for(int i = 0; i < MAX_BREAK_POINTS; i++) {
-			if(bp->table[i].status == 1) {
-				if((addr & bp->table[i].mask) == (bp->table[i].addr & bp->table[i].mask)) {
-					bp->hit = now_suspended = true;
-					bp->hit_addr = addr;
-					bp->restart = bp->table[i].check_point;
-					break;
+		if(io_flags[addr & 0xff] & bp->flag) {
+			for(int i = 0; i < bp->sorted_count; i++) {
+				int index = (int)(bp->sorted[i] & 0xffffffff);
+				if((addr & bp->table[index].mask) == (bp->table[index].addr & bp->table[index].mask)) {
+					if(hit_entry(bp, index, addr)) {
+						break;
+					}
 				}
 			}
 		}
@@ -75,6 +158,23 @@ private:
 			now_suspended = d_child->hit();
 		}
 	}
+	static int compare_key(const void *a, const void *b)
+	{
+		uint64_t key_a = *(const uint64_t *)a;
+		uint64_t key_b = *(const uint64_t *)b;
+		return (key_a < key_b) ? -1 : (key_a > key_b) ? 1 : 0;
+	}
+	void release_table(break_point_entry_t *table, int count)
+	{
+		if(table != NULL) {
+			for(int i = 0; i < count; i++) {
+				if(table[i].cond != NULL) {
+					free(table[i].cond);
+				}
+			}
+			free(table);
+		}
+	}
 public:
 	DEBUGGER(VM_TEMPLATE* parent_vm, EMU* parent_emu) : DEVICE(parent_vm, parent_emu)
 	{
@@ -83,6 +183,13 @@ public:
 		memset(&wbp, 0, sizeof(wbp));
 		memset(&ibp, 0, sizeof(ibp));
 		memset(&obp, 0, sizeof(obp));
+		bp.flag = BREAK_FLAG_EXEC;
+		rbp.flag = BREAK_FLAG_READ;
+		wbp.flag = BREAK_FLAG_WRITE;
+		ibp.flag = BREAK_FLAG_IN;
+		obp.flag = BREAK_FLAG_OUT;
+		memset(mem_flags, 0, sizeof(mem_flags));
+		memset(io_flags, 0, sizeof(io_flags));
 		first_symbol = last_symbol = NULL;
 		my_tcscpy_s(file_path, _MAX_PATH, _T("debug.bin"));
 		now_debugging = now_going = now_suspended = now_waiting = false;
@@ -112,6 +219,17 @@ public:
 	void release()
 	{
 		release_symbols();
+		break_point_t *bps[] = {&bp, &rbp, &wbp, &ibp, &obp};
+		for(int i = 0; i < 5; i++) {
+			release_table(bps[i]->table, bps[i]->count);
+			release_table(bps[i]->stored, bps[i]->stored_count);
+			if(bps[i]->sorted != NULL) {
+				free(bps[i]->sorted);
+			}
+			bps[i]->table = bps[i]->stored = NULL;
+			bps[i]->sorted = NULL;
+			bps[i]->count = bps[i]->stored_count = bps[i]->sorted_count = 0;
+		}
 	}
 	void write_data8(uint32_t addr, uint32_t data)
 	{
@@ -409,32 +527,170 @@ public:
 	{
 		check_mem_break_points(&bp, d_parent->get_next_pc(), 1);
 	}
+	int add_break_point(break_point_t *bp, uint32_t addr, uint32_t mask, bool check_point, break_cond_t *cond)
+	{
+		int index = -1;
+		for(int i = 0; i < bp->count; i++) {
+			if(bp->table[i].status != 0 && bp->table[i].addr == addr && bp->table[i].mask == mask) {
+				index = i;
+				break;
+			} else if(bp->table[i].status == 0 && index == -1) {
+				index = i;
+			}
+		}
+		if(index == -1) {
+			if(bp->count == bp->size) {
+				bp->size = (bp->size != 0) ? bp->size * 2 : 16;
+				bp->table = (break_point_entry_t *)realloc(bp->table, sizeof(break_point_entry_t) * bp->size);
+				memset(bp->table + bp->count, 0, sizeof(break_point_entry_t) * (bp->size - bp->count));
+			}
+			index = bp->count++;
+		}
+		if(bp->table[index].cond != NULL) {
+			free(bp->table[index].cond);
+		}
+		bp->table[index].addr = addr;
+		bp->table[index].mask = mask;
+		bp->table[index].status = 1;
+		bp->table[index].check_point = check_point;
+		bp->table[index].cond = cond;
+		update_break_points(bp);
+		return index;
+	}
+	void remove_break_point(break_point_t *bp, int index)
+	{
+		if(bp->table[index].cond != NULL) {
+			free(bp->table[index].cond);
+		}
+		memset(&bp->table[index], 0, sizeof(break_point_entry_t));
+		update_break_points(bp);
+	}
+	void clear_break_points(break_point_t *bp)
+	{
+		release_table(bp->table, bp->count);
+		bp->table = NULL;
+		bp->count = bp->size = 0;
+		update_break_points(bp);
+	}
+	void update_break_points(break_point_t *bp)
+	{
+		bool io = (bp == &ibp || bp == &obp);
+		
+		// clear the flags of the previous entries
+		if(io) {
+			for(int i = 0; i < 0x100; i++) {
+				io_flags[i] &= ~bp->flag;
+			}
+		} else {
+			for(int i = 0; i < bp->sorted_count; i++) {
+				mem_flags[(bp->sorted[i] >> 32) & 0xffff] &= ~bp->flag;
+			}
+		}
+		bp->sorted = (uint64_t *)realloc(bp->sorted, sizeof(uint64_t) * (bp->count + 1));
+		bp->sorted_count = 0;
+		for(int i = 0; i < bp->count; i++) {
+			if(bp->table[i].status == 1) {
+				bp->sorted[bp->sorted_count++] = ((uint64_t)bp->table[i].addr << 32) | i;
+				if(!io) {
+					mem_flags[bp->table[i].addr & 0xffff] |= bp->flag;
+				} else {
+					uint32_t mask = bp->table[i].mask & 0xff;
+					for(uint32_t port = 0; port < 0x100; port++) {
+						if((port & mask) == (bp->table[i].addr & mask)) {
+							io_flags[port] |= bp->flag;
+						}
+					}
+				}
+			}
+		}
+		qsort(bp->sorted, bp->sorted_count, sizeof(uint64_t), compare_key);
+	}
 	void store_break_points()
 	{
 		if(d_child != NULL) {
 			d_child->store_break_points();
 		}
-		memcpy( bp.stored,  bp.table, sizeof( bp.table));
-		memcpy(rbp.stored, rbp.table, sizeof(rbp.table));
-		memcpy(wbp.stored, wbp.table, sizeof(wbp.table));
-		memcpy(ibp.stored, ibp.table, sizeof(ibp.table));
-		memcpy(obp.stored, obp.table, sizeof(obp.table));
-		memset( bp.table, 0, sizeof( bp.table));
-		memset(rbp.table, 0, sizeof(rbp.table));
-		memset(wbp.table, 0, sizeof(wbp.table));
-		memset(ibp.table, 0, sizeof(ibp.table));
-		memset(obp.table, 0, sizeof(obp.table));
+		break_point_t *bps[] = {&bp, &rbp, &wbp, &ibp, &obp};
+		for(int i = 0; i < 5; i++) {
+			bps[i]->stored = bps[i]->table;
+			bps[i]->stored_count = bps[i]->count;
+			bps[i]->stored_size = bps[i]->size;
+			bps[i]->table = NULL;
+			bps[i]->count = bps[i]->size = 0;
+			update_break_points(bps[i]);
+		}
 	}
 	void restore_break_points()
 	{
 		if(d_child != NULL) {
 			d_child->restore_break_points();
 		}
-		memcpy( bp.table,  bp.stored, sizeof( bp.table));
-		memcpy(rbp.table, rbp.stored, sizeof(rbp.table));
-		memcpy(wbp.table, wbp.stored, sizeof(wbp.table));
-		memcpy(ibp.table, ibp.stored, sizeof(ibp.table));
-		memcpy(obp.table, obp.stored, sizeof(obp.table));
+		break_point_t *bps[] = {&bp, &rbp, &wbp, &ibp, &obp};
+		for(int i = 0; i < 5; i++) {
+			release_table(bps[i]->table, bps[i]->count);
+			bps[i]->table = bps[i]->stored;
+			bps[i]->count = bps[i]->stored_count;
+			bps[i]->size = bps[i]->stored_size;
+			bps[i]->stored = NULL;
+			bps[i]->stored_count = bps[i]->stored_size = 0;
+			update_break_points(bps[i]);
+		}
+	}
+	uint32_t eval_break_cond(break_cond_t *cond)
+	{
+		uint32_t stack[MAX_BREAK_COND_STACK];
+		int sp = 0;
+		
+		for(int pc = 0; pc < cond->length; pc++) {
+			uint32_t op = cond->code[pc], a, b;
+			switch(op) {
+			case BREAK_COND_NUM:
+				stack[sp++] = cond->code[++pc];
+				continue;
+			case BREAK_COND_REG:
+				stack[sp++] = d_parent->read_debug_reg(cond->regs[cond->code[++pc]]);
+				continue;
+			case BREAK_COND_MEM8:
+				stack[sp - 1] = d_parent->read_debug_data8(stack[sp - 1]);
+				continue;
+			case BREAK_COND_MEM16:
+				stack[sp - 1] = d_parent->read_debug_data16(stack[sp - 1]);
+				continue;
+			case BREAK_COND_LNOT:
+				stack[sp - 1] = (stack[sp - 1] == 0);
+				continue;
+			case BREAK_COND_NOT:
+				stack[sp - 1] = ~stack[sp - 1];
+				continue;
+			case BREAK_COND_NEG:
+				stack[sp - 1] = 0 - stack[sp - 1];
+				continue;
+			}
+			b = stack[--sp];
+			a = stack[sp - 1];
+			switch(op) {
+			case BREAK_COND_MUL:  a = a * b; break;
+			case BREAK_COND_DIV:  a = (b != 0) ? a / b : 0; break;
+			case BREAK_COND_MOD:  a = (b != 0) ? a % b : 0; break;
+			case BREAK_COND_ADD:  a = a + b; break;
+			case BREAK_COND_SUB:  a = a - b; break;
+			case BREAK_COND_SHL:  a = (b < 32) ? a << b : 0; break;
+			case BREAK_COND_SHR:  a = (b < 32) ? a >> b : 0; break;
+			case BREAK_COND_LT:   a = (a <  b); break;
+			case BREAK_COND_LE:   a = (a <= b); break;
+			case BREAK_COND_GT:   a = (a >  b); break;
+			case BREAK_COND_GE:   a = (a >= b); break;
+			case BREAK_COND_EQ:   a = (a == b); break;
+			case BREAK_COND_NE:   a = (a != b); break;
+			case BREAK_COND_AND:  a = a & b; break;
+			case BREAK_COND_XOR:  a = a ^ b; break;
+			case BREAK_COND_OR:   a = a | b; break;
+			case BREAK_COND_LAND: a = (a != 0 && b != 0); break;
+			case BREAK_COND_LOR:  a = (a != 0 || b != 0); break;
+			}
+			stack[sp - 1] = a;
+		}
+		return (sp != 0) ? stack[sp - 1] : 1;
 	}
 	bool hit()
 	{
@@ -42,6 +42,22 @@
 #define SIG_SCSI_ACK		309
 #define SIG_SCSI_RST		310
 
+// trace log categories of the devices (see _TRACE_LOG in emu.h)
+#define TRACE_MEMORY		0x00000001
+#define TRACE_FLASH		0x00000002
+#define TRACE_WATCH		0x00000004
+
+// the arguments are not evaluated when the trace log is disabled
+#ifdef _TRACE_LOG
+#define OUT_TRACE_LOG(category, ...) do { \
+	if((category) & _TRACE_LOG_CATEGORIES) { \
+		out_trace_log(category, __VA_ARGS__); \
+	} \
+} while(0)
+#else
+#define OUT_TRACE_LOG(category, ...)
+#endif
+
 class DEVICE
 {
 protected:
@@ -68,7 +84,7 @@ public:
 		// primary event manager
 		event_manager = NULL;
 	}
-	~DEVICE(void) {}
+	virtual ~DEVICE(void) {}
 	
 	virtual void initialize() {}
 	virtual void release() {}
@@ -680,6 +696,13 @@ public:
 		}
 		event_manager->update_extra_event(clock);
 	}
+	virtual int* get_extra_event_limit_ptr()
+	{
+		if(event_manager == NULL) {
+			event_manager = vm->first_device->next_device;
+		}
+		return event_manager->get_extra_event_limit_ptr();
+	}
 	virtual void register_event(DEVICE* device, int event_id, double usec, bool loop, int* register_id)
 	{
 		if(event_manager == NULL) {
@@ -715,6 +738,13 @@ public:
 		}
 		event_manager->register_vline_event(device);
 	}
+	virtual void register_vline_timeline_event(DEVICE* device, int event_id, int clock)
+	{
+		if(event_manager == NULL) {
+			event_manager = vm->first_device->next_device;
+		}
+		event_manager->register_vline_timeline_event(device, event_id, clock);
+	}
 	virtual uint32_t get_event_remaining_clock(int register_id)
 	{
 		if(event_manager == NULL) {
@@ -845,6 +875,10 @@ public:
 	
 	// sound
 	virtual void mix(int32_t* buffer, int cnt) {}
+	virtual bool is_sound_silent()	// true if mix() outputs nothing now, and then it is not called
+	{
+		return false;
+	}
 	virtual void set_volume(int ch, int decibel_l, int decibel_r) {} // +1 equals +0.5dB (same as fmgen)
 	
 #ifdef USE_DEBUGGER
@@ -948,6 +982,12 @@ public:
 	{
 		return 0;
 	}
+	// the names in the conditions of breakpoints are checked when they are compiled,
+	// the devices that do not check them read 0 for the unknown names
+	virtual bool is_debug_reg(const _TCHAR *reg)
+	{
+		return true;
+	}
 	virtual bool get_debug_regs_info(_TCHAR *buffer, size_t buffer_len)
 	{
 		return false;
@@ -956,6 +996,29 @@ public:
 	{
 		return 0;
 	}
+	// execution trace of cpu
+	virtual bool save_debug_trace(const _TCHAR *file_path)
+	{
+		return false;
+	}
+	virtual bool decode_debug_trace(const _TCHAR *trace_path, const _TCHAR *text_path)
+	{
+		return false;
+	}
+	// profiler of cpu
+	virtual void add_debug_profile_wait(int clock) {}
+	virtual void clear_debug_profile() {}
+	virtual bool save_debug_profile(const _TCHAR *report_path, const _TCHAR *stack_path)
+	{
+		return false;
+	}
+	// memory access heatmap of cpu
+	virtual void set_debug_watch(uint32_t addr, bool value) {}
+	virtual void clear_debug_heatmap() {}
+	virtual bool save_debug_heatmap(const _TCHAR *image_path, const _TCHAR *report_path)
+	{
+		return false;
+	}
 #endif
 /*
 	These functions are used for debugging non-cpu device
@@ -1060,6 +1123,20 @@ public:
 		
 		emu->force_out_debug_log(_T("%s"), buffer);
 	}
+#ifdef _TRACE_LOG
+	// called with OUT_TRACE_LOG()
+	void out_trace_log(uint32_t category, const _TCHAR* format, ...)
+	{
+		va_list ap;
+		_TCHAR buffer[1024];
+		
+		va_start(ap, format);
+		my_vstprintf_s(buffer, 1024, format, ap);
+		va_end(ap);
+		
+		emu->out_trace_log(_T("%10u %s: %s"), get_current_clock(), this_device_name, buffer);
+	}
+#endif
 	void set_device_name(const _TCHAR* format, ...)
 	{
 		if(format != NULL) {
@@ -8,9 +8,41 @@
 */
 
 #include "event.h"
+#include "../sound_writer.h"
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SOUND_CLAMP_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define SOUND_CLAMP_NEON
+#endif
 
 #define EVENT_MIX	0
 
+// convert the mixed samples to int16 with saturation, 8 samples per step
+static void clamp_sound(const int32_t* src, uint16_t* dst, int count)
+{
+	int i = 0;
+#if defined(SOUND_CLAMP_SSE2)
+	for(; i + 8 <= count; i += 8) {
+		__m128i lo = _mm_loadu_si128((const __m128i*)(src + i));
+		__m128i hi = _mm_loadu_si128((const __m128i*)(src + i + 4));
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(lo, hi));
+	}
+#elif defined(SOUND_CLAMP_NEON)
+	for(; i + 8 <= count; i += 8) {
+		int16x4_t lo = vqmovn_s32(vld1q_s32(src + i));
+		int16x4_t hi = vqmovn_s32(vld1q_s32(src + i + 4));
+		vst1q_s16((int16_t*)(dst + i), vcombine_s16(lo, hi));
+	}
+#endif
+	for(; i < count; i++) {
+		int32_t dat = src[i];
+		dst[i] = (uint16_t)((dat > 32767) ? 32767 : (dat < -32768) ? -32768 : dat);
+	}
+}
+
 void EVENT::initialize()
 {
 	// load config
@@ -18,6 +50,7 @@ void EVENT::initialize()
 		config.cpu_power = 0;
 	}
 	power = config.cpu_power;
+	update_extra_event_limit();
 	
 	// initialize sound buffer
 	sound_buffer = NULL;
@@ -43,7 +76,7 @@ void EVENT::initialize_sound(int rate, int samples)
 	memset(sound_tmp, 0, sound_tmp_samples * sizeof(int32_t) * 2);
 	buffer_ptr = 0;
 	mix_counter = 1;
-	mix_limit = (int)((double)(emu->get_sound_rate() / 2000.0)); // per 0.5ms.
+	mix_limit = (int)((double)(rate / 2000.0)); // per 0.5ms.
 	
 	// register event
 	this->register_event(this, EVENT_MIX, 1000000.0 / rate, true, NULL);
@@ -52,6 +85,7 @@ void EVENT::initialize_sound(int rate, int samples)
 void EVENT::release()
 {
 	// release sound
+	stop_record_sound_stems();
 	if(sound_buffer) {
 		free(sound_buffer);
 	}
@@ -127,6 +161,7 @@ void EVENT::drive()
 	}
 	for(cur_vline = 0; cur_vline < lines_per_frame; cur_vline++) {
 		vline_start_clock = get_current_clock();
+		start_vline_timeline();
 		
 		// run virtual machine per line
 		for(int i = 0; i < vline_event_count; i++) {
@@ -142,6 +177,7 @@ void EVENT::drive()
 		}
 		event_remain += vclocks[cur_vline];
 		cpu_remain += vclocks[cur_vline] << power;
+		update_extra_event_limit();
 		
 		while(event_remain > 0) {
 			int event_done = event_remain;
@@ -175,6 +211,7 @@ void EVENT::drive()
 				}
 				cpu_remain -= cpu_done_tmp;
 				cpu_accum += cpu_done_tmp;
+				total_cpu_clocks += cpu_done_tmp;
 				event_done = cpu_accum >> power;
 				cpu_accum -= event_done << power;
 				event_done -= event_extra;
@@ -189,6 +226,7 @@ void EVENT::drive()
 				}
 				event_remain -= event_done;
 			}
+			update_extra_event_limit();
 		}
 	}
 }
@@ -208,6 +246,7 @@ void EVENT::update_extra_event(int clock)
 		}
 		event_remain -= event_done;
 		event_extra += event_done;
+		update_extra_event_limit();
 	}
 }
 
@@ -215,19 +254,29 @@ void EVENT::update_event(int clock)
 {
 	uint64_t event_clocks_tmp = event_clocks + clock;
 	
+#ifdef EVENT_LIST_SCHEDULER
 	while(first_fire_event != NULL && first_fire_event->expired_clock <= event_clocks_tmp) {
 		event_t *event_handle = first_fire_event;
 		uint64_t expired_clock = event_handle->expired_clock;
+		int event_id = event_handle->event_id;
 		
 		first_fire_event = event_handle->next;
 		if(first_fire_event != NULL) {
 			first_fire_event->prev = NULL;
 		}
-		if(event_handle->loop_clock != 0) {
+		if(event_handle->timeline != NULL) {
+			if(next_vline_timeline_event(event_handle)) {
+				insert_event(event_handle);
+			} else {
+				event_handle->active = false;
+				event_handle->next = NULL;
+			}
+		} else if(event_handle->loop_clock != 0) {
 			event_handle->accum_clocks += event_handle->loop_clock;
 			uint64_t clock_tmp = event_handle->accum_clocks >> 10;
 			event_handle->accum_clocks -= clock_tmp << 10;
 			event_handle->expired_clock += clock_tmp;
+			event_handle->insert_order = insert_count++;
 			insert_event(event_handle);
 		} else {
 			event_handle->active = false;
@@ -235,11 +284,69 @@ void EVENT::update_event(int clock)
 			first_free_event = event_handle;
 		}
 		event_clocks = expired_clock;
-		event_handle->device->event_callback(event_handle->event_id, 0);
+		total_fired_events++;
+		event_handle->device->event_callback(event_id, 0);
+	}
+#else
+	while(fire_heap_count != 0 && fire_heap[0]->expired_clock <= event_clocks_tmp) {
+		event_t *event_handle = fire_heap[0];
+		uint64_t expired_clock = event_handle->expired_clock;
+		int event_id = event_handle->event_id;
+		
+		if(event_handle->timeline != NULL) {
+			if(next_vline_timeline_event(event_handle)) {
+				sift_down_event(0);
+			} else {
+				remove_event(event_handle);
+				event_handle->active = false;
+				event_handle->next = event_handle->prev = NULL;
+			}
+		} else if(event_handle->loop_clock != 0) {
+			// reschedule in place, it is placed after the events with same clock
+			event_handle->accum_clocks += event_handle->loop_clock;
+			uint64_t clock_tmp = event_handle->accum_clocks >> 10;
+			event_handle->accum_clocks -= clock_tmp << 10;
+			event_handle->expired_clock += clock_tmp;
+			event_handle->insert_order = insert_count++;
+			sift_down_event(0);
+		} else {
+			remove_event(event_handle);
+			event_handle->active = false;
+			event_handle->next = first_free_event;
+			first_free_event = event_handle;
+		}
+		event_clocks = expired_clock;
+		total_fired_events++;
+		event_handle->device->event_callback(event_id, 0);
 	}
+#endif
 	event_clocks = event_clocks_tmp;
 }
 
+void EVENT::update_extra_event_limit()
+{
+#ifdef EVENT_LIST_SCHEDULER
+	event_t *event_handle = first_fire_event;
+#else
+	event_t *event_handle = (fire_heap_count != 0) ? fire_heap[0] : NULL;
+#endif
+	if(power != 0 || dcount_cpu > 1) {
+		// clocks are divided in update_extra_event or sub cpus are synchronized,
+		// so they can not be passed at once
+		extra_event_limit = 0;
+	} else {
+		// the current line should be also finished
+		extra_event_limit = max(min(event_remain, cpu_remain), 0);
+		if(event_handle != NULL) {
+			if(event_handle->expired_clock <= event_clocks) {
+				extra_event_limit = 0;
+			} else if(event_handle->expired_clock - event_clocks < (uint64_t)extra_event_limit) {
+				extra_event_limit = (int)(event_handle->expired_clock - event_clocks);
+			}
+		}
+	}
+}
+
 uint32_t EVENT::get_current_clock()
 {
 	return (uint32_t)(event_clocks & 0xffffffff);
@@ -315,6 +422,7 @@ void EVENT::register_event(DEVICE* device, int event_id, double usec, bool loop,
 		event_handle->accum_clocks = 0;
 	}
 	event_handle->expired_clock = event_clocks + clock;
+	event_handle->insert_order = insert_count++;
 	
 	insert_event(event_handle);
 }
@@ -349,18 +457,21 @@ void EVENT::register_event_by_clock(DEVICE* device, int event_id, uint64_t clock
 	event_handle->expired_clock = event_clocks + clock;
 	event_handle->loop_clock = loop ? (clock << 10) : 0;
 	event_handle->accum_clocks = 0;
+	event_handle->insert_order = insert_count++;
 	
 	insert_event(event_handle);
 }
 
+#ifdef EVENT_LIST_SCHEDULER
 void EVENT::insert_event(event_t *event_handle)
 {
+	total_inserted_events++;
 	if(first_fire_event == NULL) {
 		first_fire_event = event_handle;
 		event_handle->prev = event_handle->next = NULL;
 	} else {
 		for(event_t *insert_pos = first_fire_event; insert_pos != NULL; insert_pos = insert_pos->next) {
-			if(insert_pos->expired_clock > event_handle->expired_clock) {
+			if(is_fired_before(event_handle, insert_pos)) {
 				if(insert_pos->prev != NULL) {
 					// insert
 					insert_pos->prev->next = event_handle;
@@ -385,7 +496,114 @@ void EVENT::insert_event(event_t *event_handle)
 			}
 		}
 	}
+	update_extra_event_limit();
+}
+
+void EVENT::remove_event(event_t *event_handle)
+{
+	if(event_handle->prev != NULL) {
+		event_handle->prev->next = event_handle->next;
+	} else {
+		first_fire_event = event_handle->next;
+	}
+	if(event_handle->next != NULL) {
+		event_handle->next->prev = event_handle->prev;
+	}
+	update_extra_event_limit();
+}
+#else
+void EVENT::insert_event(event_t *event_handle)
+{
+	total_inserted_events++;
+	event_handle->heap_index = fire_heap_count;
+	fire_heap[fire_heap_count++] = event_handle;
+	sift_up_event(event_handle->heap_index);
+	update_extra_event_limit();
+}
+
+void EVENT::remove_event(event_t *event_handle)
+{
+	int pos = event_handle->heap_index;
+	event_t *last_handle = fire_heap[--fire_heap_count];
+	
+	if(last_handle != event_handle) {
+		fire_heap[pos] = last_handle;
+		last_handle->heap_index = pos;
+		if(pos > 0 && is_fired_before(last_handle, fire_heap[(pos - 1) >> 2])) {
+			sift_up_event(pos);
+		} else {
+			sift_down_event(pos);
+		}
+	}
+	update_extra_event_limit();
+}
+
+void EVENT::sift_up_event(int pos)
+{
+	event_t *event_handle = fire_heap[pos];
+	
+	while(pos > 0) {
+		int parent = (pos - 1) >> 2;
+		if(!is_fired_before(event_handle, fire_heap[parent])) {
+			break;
+		}
+		fire_heap[pos] = fire_heap[parent];
+		fire_heap[pos]->heap_index = pos;
+		pos = parent;
+	}
+	fire_heap[pos] = event_handle;
+	event_handle->heap_index = pos;
+}
+
+void EVENT::sift_down_event(int pos)
+{
+	event_t *event_handle = fire_heap[pos];
+	
+	while(1) {
+		int child = (pos << 2) + 1;
+		if(child >= fire_heap_count) {
+			break;
+		}
+		// find the first child to be fired
+		int last = (child + 4 < fire_heap_count) ? child + 4 : fire_heap_count;
+		for(int i = child + 1; i < last; i++) {
+			if(is_fired_before(fire_heap[i], fire_heap[child])) {
+				child = i;
+			}
+		}
+		if(!is_fired_before(fire_heap[child], event_handle)) {
+			break;
+		}
+		fire_heap[pos] = fire_heap[child];
+		fire_heap[pos]->heap_index = pos;
+		pos = child;
+	}
+	fire_heap[pos] = event_handle;
+	event_handle->heap_index = pos;
+}
+
+EVENT::event_t *EVENT::link_fire_heap()
+{
+	// link the queued events in fired order to save them as the linked list
+	event_t *sorted[MAX_EVENT];
+	int count = 0;
+	
+	for(int i = 0; i < fire_heap_count; i++) {
+		event_t *event_handle = fire_heap[i];
+		int pos = count++;
+		while(pos > 0 && is_fired_before(event_handle, sorted[pos - 1])) {
+			sorted[pos] = sorted[pos - 1];
+			pos--;
+		}
+		sorted[pos] = event_handle;
+	}
+	for(int i = 0; i < count; i++) {
+		sorted[i]->prev = (i > 0) ? sorted[i - 1] : NULL;
+		sorted[i]->next = (i + 1 < count) ? sorted[i + 1] : NULL;
+	}
+	return (count > 0) ? sorted[0] : NULL;
 }
+#endif
 
 void EVENT::cancel_event(DEVICE* device, int register_id)
 {
@@ -397,17 +615,14 @@ void EVENT::cancel_event(DEVICE* device, int register_id)
 			return;
 		}
 		if(event_handle->active) {
-			if(event_handle->prev != NULL) {
-				event_handle->prev->next = event_handle->next;
+			remove_event(event_handle);
+			event_handle->active = false;
+			if(event_handle->timeline == NULL) {
+				event_handle->next = first_free_event;
+				first_free_event = event_handle;
 			} else {
-				first_fire_event = event_handle->next;
-			}
-			if(event_handle->next != NULL) {
-				event_handle->next->prev = event_handle->prev;
+				event_handle->next = event_handle->prev = NULL;
 			}
-			event_handle->active = false;
-			event_handle->next = first_free_event;
-			first_free_event = event_handle;
 		}
 	}
 }
@@ -450,6 +665,92 @@ void EVENT::register_vline_event(DEVICE* device)
 	}
 }
 
+void EVENT::register_vline_timeline_event(DEVICE* device, int event_id, int clock)
+{
+	// clock is from the start of line, and it should be less than the clocks of one line
+	vline_timeline_t *timeline = NULL;
+	for(int i = 0; i < vline_timeline_count; i++) {
+		if(vline_timeline[i].device == device) {
+			timeline = &vline_timeline[i];
+			break;
+		}
+	}
+	if(timeline == NULL) {
+		if(vline_timeline_count >= MAX_VLINE_TIMELINE || first_free_event == NULL) {
+#ifdef _DEBUG_LOG
+			this->out_debug_log(_T("EVENT: too many vline timelines !!!\n"));
+#endif
+			return;
+		}
+		timeline = &vline_timeline[vline_timeline_count++];
+		timeline->device = device;
+		timeline->count = timeline->next = 0;
+		
+		// this event handle is never released
+		event_t *event_handle = first_free_event;
+		first_free_event = first_free_event->next;
+		event_handle->active = false;
+		event_handle->device = device;
+		event_handle->loop_clock = 0;
+		event_handle->accum_clocks = 0;
+		event_handle->timeline = timeline;
+		timeline->event_handle = event_handle;
+	}
+	if(timeline->count >= MAX_VLINE_TIMELINE_EVENT) {
+#ifdef _DEBUG_LOG
+		this->out_debug_log(_T("EVENT: device (name=%s, id=%d) has too many vline timeline events !!!\n"), device->this_device_name, device->this_device_id);
+#endif
+		return;
+	}
+	
+	// sort by clock, the events with same clock are fired in registered order
+	int pos = timeline->count++;
+	while(pos > 0 && timeline->clock[pos - 1] > clock) {
+		timeline->event_id[pos] = timeline->event_id[pos - 1];
+		timeline->clock[pos] = timeline->clock[pos - 1];
+		pos--;
+	}
+	timeline->event_id[pos] = event_id;
+	timeline->clock[pos] = clock;
+}
+
+void EVENT::start_vline_timeline()
+{
+	for(int i = 0; i < vline_timeline_count; i++) {
+		vline_timeline_t *timeline = &vline_timeline[i];
+		event_t *event_handle = timeline->event_handle;
+		
+		if(event_handle->active) {
+			// the events exceeding the previous line are not fired
+			remove_event(event_handle);
+		}
+		// reserve the registered order for all events in the timeline
+		timeline->next = 0;
+		timeline->start_clock = event_clocks;
+		timeline->start_order = insert_count;
+		insert_count += timeline->count;
+		
+		event_handle->active = true;
+		event_handle->event_id = timeline->event_id[0];
+		event_handle->expired_clock = timeline->start_clock + timeline->clock[0];
+		event_handle->insert_order = timeline->start_order;
+		insert_event(event_handle);
+	}
+}
+
+bool EVENT::next_vline_timeline_event(event_t *event_handle)
+{
+	vline_timeline_t *timeline = event_handle->timeline;
+	
+	if(++timeline->next < timeline->count) {
+		event_handle->event_id = timeline->event_id[timeline->next];
+		event_handle->expired_clock = timeline->start_clock + timeline->clock[timeline->next];
+		event_handle->insert_order = timeline->start_order + timeline->next;
+		return true;
+	}
+	return false;
+}
+
 uint32_t EVENT::get_event_remaining_clock(int register_id)
 {
 	if(0 <= register_id && register_id < MAX_EVENT) {
@@ -533,11 +834,29 @@ void EVENT::mix_sound(int samples)
 {
 	if(samples > 0) {
 		int32_t* buffer = sound_tmp + buffer_ptr * 2;
+		bool silent = true;
 		memset(buffer, 0, samples * sizeof(int32_t) * 2);
 		for(int i = 0; i < dcount_sound; i++) {
-			d_sound[i]->mix(buffer, samples);
+			if(stem_writer != NULL) {
+				// mix the device alone, and add it to the mixed samples
+				int32_t* stem = stem_tmp[i] + buffer_ptr * 2;
+				memset(stem, 0, samples * sizeof(int32_t) * 2);
+				if(!d_sound[i]->is_sound_silent()) {
+					d_sound[i]->mix(stem, samples);
+					for(int j = 0; j < samples * 2; j++) {
+						buffer[j] += stem[j];
+					}
+					silent = false;
+				}
+			} else if(!d_sound[i]->is_sound_silent()) {
+				// skip the device that has no output
+				d_sound[i]->mix(buffer, samples);
+				silent = false;
+			}
 		}
-		if(!sound_changed) {
+		if(!sound_changed && silent) {
+			sound_changed = (sound_tmp[0] != 0 || sound_tmp[1] != 0);
+		} else if(!sound_changed) {
 			for(int i = 0; i < samples * 2; i += 2) {
 				if(buffer[i] != sound_tmp[0] || buffer[i + 1] != sound_tmp[1]) {
 					sound_changed = true;
@@ -558,6 +877,9 @@ uint16_t* EVENT::create_sound(int* extra_frames)
 {
 	if(prev_skip && dont_skip_frames == 0 && !sound_changed) {
 		memset(sound_buffer, 0, sound_samples * sizeof(uint16_t) * 2);
+		if(stem_writer != NULL) {
+			write_sound_stems(true);
+		}
 		*extra_frames = 0;
 		return sound_buffer;
 	}
@@ -577,23 +899,18 @@ uint16_t* EVENT::create_sound(int* extra_frames)
 	}
 #endif
 	// copy to buffer
-	for(int i = 0; i < sound_samples * 2; i++) {
-		int dat = sound_tmp[i];
-		uint16_t highlow = (uint16_t)(dat & 0x0000ffff);
-		
-		if((dat > 0) && (highlow >= 0x8000)) {
-			sound_buffer[i] = 0x7fff;
-			continue;
-		}
-		if((dat < 0) && (highlow < 0x8000)) {
-			sound_buffer[i] = 0x8000;
-			continue;
-		}
-		sound_buffer[i] = highlow;
+	clamp_sound(sound_tmp, sound_buffer, sound_samples * 2);
+	if(stem_writer != NULL) {
+		write_sound_stems(false);
 	}
 	if(buffer_ptr > sound_samples) {
 		buffer_ptr -= sound_samples;
 		memcpy(sound_tmp, sound_tmp + sound_samples * 2, buffer_ptr * sizeof(int32_t) * 2);
+		if(stem_writer != NULL) {
+			for(int i = 0; i < dcount_sound; i++) {
+				memcpy(stem_tmp[i], stem_tmp[i] + sound_samples * 2, buffer_ptr * sizeof(int32_t) * 2);
+			}
+		}
 	} else {
 		buffer_ptr = 0;
 	}
@@ -606,6 +923,73 @@ int EVENT::get_sound_buffer_ptr()
 	return buffer_ptr;
 }
 
+bool EVENT::start_record_sound_stems(SOUND_WRITER* writer, const _TCHAR* prefix)
+{
+	if(stem_writer != NULL || sound_tmp == NULL) {
+		return false;
+	}
+	for(int i = 0; i < dcount_sound; i++) {
+		// <prefix>_<index>_<device name>.wav, the name is converted to be a file name
+		_TCHAR name[128], file_path[_MAX_PATH];
+		int length = 0;
+		for(const _TCHAR *p = d_sound[i]->this_device_name; *p != _T('\0') && length < 127; p++) {
+			if((*p >= _T('0') && *p <= _T('9')) || (*p >= _T('A') && *p <= _T('Z')) || (*p >= _T('a') && *p <= _T('z'))) {
+				name[length++] = *p;
+			} else if(length > 0 && name[length - 1] != _T('_')) {
+				name[length++] = _T('_');
+			}
+		}
+		while(length > 0 && name[length - 1] == _T('_')) {
+			length--;
+		}
+		name[length] = _T('\0');
+		my_stprintf_s(file_path, _MAX_PATH, _T("%s_%02d_%s.wav"), prefix, i, name);
+		
+		if((stem_id[i] = writer->open(file_path, emu->get_sound_rate(), true)) == -1) {
+			while(--i >= 0) {
+				writer->close(stem_id[i]);
+			}
+			return false;
+		}
+	}
+	for(int i = 0; i < dcount_sound; i++) {
+		stem_tmp[i] = (int32_t*)calloc(sound_tmp_samples * 2, sizeof(int32_t));
+	}
+	stem_buffer = (uint16_t*)malloc(sound_samples * sizeof(uint16_t) * 2);
+	// start from the current sample as OSD records the mixed samples
+	stem_buffer_ptr = buffer_ptr;
+	stem_writer = writer;
+	return true;
+}
+
+void EVENT::stop_record_sound_stems()
+{
+	if(stem_writer != NULL) {
+		for(int i = 0; i < dcount_sound; i++) {
+			stem_writer->close(stem_id[i]);
+			free(stem_tmp[i]);
+		}
+		free(stem_buffer);
+		stem_writer = NULL;
+	}
+}
+
+void EVENT::write_sound_stems(bool silent)
+{
+	if(sound_samples > stem_buffer_ptr) {
+		int samples = sound_samples - stem_buffer_ptr;
+		for(int i = 0; i < dcount_sound; i++) {
+			if(silent) {
+				memset(stem_buffer, 0, samples * sizeof(uint16_t) * 2);
+			} else {
+				clamp_sound(stem_tmp[i] + stem_buffer_ptr * 2, stem_buffer, samples * 2);
+			}
+			stem_writer->write(stem_id[i], (int16_t*)stem_buffer, samples);
+		}
+	}
+	stem_buffer_ptr = 0;
+}
+
 void EVENT::request_skip_frames()
 {
 	next_skip = true;
@@ -634,10 +1018,11 @@ void EVENT::update_config()
 	if(power != config.cpu_power) {
 		power = config.cpu_power;
 		cpu_accum = 0;
+		update_extra_event_limit();
 	}
 }
 
-#define STATE_VERSION	4
+#define STATE_VERSION	5
 
 bool EVENT::process_state(FILEIO* state_fio, bool loading)
 {
@@ -662,6 +1047,10 @@ bool EVENT::process_state(FILEIO* state_fio, bool loading)
 	state_fio->StateValue(cpu_accum);
 	state_fio->StateValue(cpu_done);
 	state_fio->StateValue(event_clocks);
+#ifndef EVENT_LIST_SCHEDULER
+	// the fired order is saved as the linked list
+	event_t *first_fire_event = loading ? NULL : link_fire_heap();
+#endif
 	for(int i = 0; i < MAX_EVENT; i++) {
 		if(loading) {
 			event[i].device = vm->get_device(state_fio->FgetInt32_LE());
@@ -673,6 +1062,7 @@ bool EVENT::process_state(FILEIO* state_fio, bool loading)
 		state_fio->StateValue(event[i].loop_clock);
 		state_fio->StateValue(event[i].accum_clocks);
 		state_fio->StateValue(event[i].active);
+		state_fio->StateValue(event[i].insert_order);
 		if(loading) {
 			event[i].next = (event_t *)get_event(state_fio->FgetInt32_LE());
 			event[i].prev = (event_t *)get_event(state_fio->FgetInt32_LE());
@@ -688,6 +1078,26 @@ bool EVENT::process_state(FILEIO* state_fio, bool loading)
 		state_fio->FputInt32_LE(first_free_event != NULL ? first_free_event->index : -1);
 		state_fio->FputInt32_LE(first_fire_event != NULL ? first_fire_event->index : -1);
 	}
+	state_fio->StateValue(insert_count);
+	if(!state_fio->StateCheckInt32(vline_timeline_count)) {
+		return false;
+	}
+	for(int i = 0; i < vline_timeline_count; i++) {
+		if(!state_fio->StateCheckInt32(vline_timeline[i].event_handle->index)) {
+			return false;
+		}
+		state_fio->StateValue(vline_timeline[i].next);
+		state_fio->StateValue(vline_timeline[i].start_clock);
+		state_fio->StateValue(vline_timeline[i].start_order);
+	}
+#ifndef EVENT_LIST_SCHEDULER
+	if(loading) {
+		fire_heap_count = 0;
+		for(event_t *event_handle = first_fire_event; event_handle != NULL; event_handle = event_handle->next) {
+			insert_event(event_handle);
+		}
+	}
+#endif
 	state_fio->StateValue(frames_per_sec);
 	state_fio->StateValue(next_frames_per_sec);
 	state_fio->StateValue(lines_per_frame);
@@ -706,6 +1116,7 @@ bool EVENT::process_state(FILEIO* state_fio, bool loading)
 		buffer_ptr = 0;
 		mix_counter = 1;
 		mix_limit = (int)((double)(emu->get_sound_rate() / 2000.0));  // per 0.5ms.
+		update_extra_event_limit();
 	}
 	return true;
 }
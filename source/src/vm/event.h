@@ -20,6 +20,16 @@
 #define MAX_LINES	1024
 #define MAX_EVENT	64
 #define NO_EVENT	-1
+#define MAX_VLINE_TIMELINE	4
+#define MAX_VLINE_TIMELINE_EVENT	16
+
+class SOUND_WRITER;
+
+// event scheduler
+// define EVENT_LIST_SCHEDULER to use the sorted linked list instead of the 4-ary heap.
+// both fire the events in the same order: by expired clock, and by registered order
+// if the expired clocks are same.
+//#define EVENT_LIST_SCHEDULER
 
 class EVENT : public DEVICE
 {
@@ -40,6 +50,17 @@ private:
 	int cpu_remain, cpu_accum, cpu_done;
 	uint64_t event_clocks;
 	
+	// statistics for the batch runner, not saved in the state file
+	uint64_t total_cpu_clocks;
+	uint64_t total_fired_events;
+	uint64_t total_inserted_events;
+	
+	// the primary cpu can pass these clocks to update_extra_event at once,
+	// no event is fired and the current line is not finished while them
+	int extra_event_limit;
+	void update_extra_event_limit();
+	
+	struct vline_timeline_t;
 	typedef struct event_t {
 		DEVICE* device;
 		int event_id;
@@ -50,15 +71,54 @@ private:
 		int index;
 		event_t *next;
 		event_t *prev;
+		uint64_t insert_order;
+#ifndef EVENT_LIST_SCHEDULER
+		int heap_index;
+#endif
+		struct vline_timeline_t *timeline;
 	} event_t;
 	event_t event[MAX_EVENT];
 	event_t *first_free_event;
+	uint64_t insert_count;
+	
+	inline bool is_fired_before(event_t *a, event_t *b)
+	{
+		return (a->expired_clock < b->expired_clock || (a->expired_clock == b->expired_clock && a->insert_order < b->insert_order));
+	}
+#ifdef EVENT_LIST_SCHEDULER
 	event_t *first_fire_event;
+#else
+	event_t *fire_heap[MAX_EVENT];
+	int fire_heap_count;
+	
+	void sift_up_event(int pos);
+	void sift_down_event(int pos);
+	event_t *link_fire_heap();
+#endif
 	
 	DEVICE* frame_event[MAX_EVENT];
 	DEVICE* vline_event[MAX_EVENT];
 	int frame_event_count, vline_event_count;
 	
+	// static events fired at the same clocks in every line.
+	// one event handle per device is queued for the next event in the timeline,
+	// and the events are fired in the same order as they are registered in each line
+	typedef struct vline_timeline_t {
+		DEVICE* device;
+		int event_id[MAX_VLINE_TIMELINE_EVENT];
+		int clock[MAX_VLINE_TIMELINE_EVENT];
+		int count;
+		int next;
+		uint64_t start_clock;
+		uint64_t start_order;
+		event_t *event_handle;
+	} vline_timeline_t;
+	vline_timeline_t vline_timeline[MAX_VLINE_TIMELINE];
+	int vline_timeline_count;
+	
+	void start_vline_timeline();
+	bool next_vline_timeline_event(event_t *event_handle);
+	
 	double frames_per_sec, next_frames_per_sec;
 	int lines_per_frame, next_lines_per_frame;
 	uint32_t vline_start_clock;
@@ -67,6 +127,7 @@ private:
 	
 	void update_event(int clock);
 	void insert_event(event_t *event_handle);
+	void remove_event(event_t *event_handle);
 	
 	// sound manager
 	DEVICE* d_sound[MAX_SOUND];
@@ -87,7 +148,16 @@ private:
 	bool dev_need_mix[MAX_DEVICE];
 	int need_mix;
 	
+	// stems : the samples of each sound device are kept in the same layout
+	// as sound_tmp, and written with the mixed samples in create_sound()
+	SOUND_WRITER* stem_writer;
+	int stem_id[MAX_SOUND];
+	int32_t* stem_tmp[MAX_SOUND];
+	uint16_t* stem_buffer;
+	int stem_buffer_ptr;
+	
 	void mix_sound(int samples);
+	void write_sound_stems(bool silent);
 	void* get_event(int index);
 	
 #ifdef _DEBUG_LOG
@@ -108,9 +178,17 @@ public:
 			event[i].next = (i + 1 < MAX_EVENT) ? &event[i + 1] : NULL;
 		}
 		first_free_event = &event[0];
+		insert_count = 0;
+#ifdef EVENT_LIST_SCHEDULER
 		first_fire_event = NULL;
+#else
+		fire_heap_count = 0;
+#endif
+		vline_timeline_count = 0;
 		
 		event_clocks = 0;
+		extra_event_limit = 0;
+		total_cpu_clocks = total_fired_events = total_inserted_events = 0;
 		
 		// force update timing in the first frame
 		frames_per_sec = 0.0;
@@ -122,6 +200,8 @@ public:
 		memset(dev_need_mix, 0, sizeof(dev_need_mix));
 		need_mix = 0;
 		
+		stem_writer = NULL;
+		
 #ifdef _DEBUG_LOG
 		initialize_done = false;
 #endif
@@ -174,11 +254,16 @@ public:
 		return next_lines_per_frame;
 	}
 	void update_extra_event(int clock);
+	int* get_extra_event_limit_ptr()
+	{
+		return &extra_event_limit;
+	}
 	void register_event(DEVICE* device, int event_id, double usec, bool loop, int* register_id);
 	void register_event_by_clock(DEVICE* device, int event_id, uint64_t clock, bool loop, int* register_id);
 	void cancel_event(DEVICE* device, int register_id);
 	void register_frame_event(DEVICE* device);
 	void register_vline_event(DEVICE* device);
+	void register_vline_timeline_event(DEVICE* device, int event_id, int clock);
 	uint32_t get_event_remaining_clock(int register_id);
 	double get_event_remaining_usec(int register_id);
 	uint32_t get_current_clock();
@@ -206,10 +291,24 @@ public:
 		return next_frames_per_sec;
 	}
 	void drive();
+	uint64_t get_total_cpu_clocks()
+	{
+		return total_cpu_clocks;
+	}
+	uint64_t get_total_fired_events()
+	{
+		return total_fired_events;
+	}
+	uint64_t get_total_inserted_events()
+	{
+		return total_inserted_events;
+	}
 	
 	void initialize_sound(int rate, int samples);
 	uint16_t* create_sound(int* extra_frames);
 	int get_sound_buffer_ptr();
+	bool start_record_sound_stems(SOUND_WRITER* writer, const _TCHAR* prefix);
+	void stop_record_sound_stems();
 	
 	void set_context_cpu(DEVICE* device, uint32_t clocks)
 	{
@@ -0,0 +1,65 @@
+/*
+	SHARP MZ-700 Emulator 'EmuZ-700'
+	SHARP MZ-1500 Emulator 'EmuZ-1500'
+
+	Date   : 2026.10.17-
+
+	[ dot expander ]
+*/
+
+#ifndef _DOT_EXPANDER_H_
+#define _DOT_EXPANDER_H_
+
+#include "../../common.h"
+
+// 8 dots of a pattern are expanded to 8 bytes at once
+#define DOT_BYTES	0x0101010101010101ULL
+
+// the color codes of 8 dots are packed into uint64_t in the order of the
+// screen, and stored to the screen with one memcpy
+class DOT_EXPANDER
+{
+private:
+	uint64_t dot_mask[256];
+
+public:
+	DOT_EXPANDER()
+	{
+		// the byte is 0xff when the dot is set and the msb is the left dot,
+		// built byte by byte to work on any endianness
+		for(int i = 0; i < 256; i++) {
+			uint8_t mask[8];
+			for(int j = 0; j < 8; j++) {
+				mask[j] = (i & (0x80 >> j)) ? 0xff : 0;
+			}
+			memcpy(&dot_mask[i], mask, 8);
+		}
+	}
+	~DOT_EXPANDER() {}
+
+	// text dots : the fore/back colors, selected with the text mask
+	inline uint64_t expand_text(uint8_t pat_t, uint8_t col_f, uint8_t col_b)
+	{
+		uint64_t mask_t = dot_mask[pat_t];
+		return (mask_t & (col_f * DOT_BYTES)) | (~mask_t & (col_b * DOT_BYTES));
+	}
+	// pcg dots of MZ-1500 : the three plane masks, each ANDed with its color bit,
+	// and the byte-wise select with the masks of text and non-zero pcg dots
+	inline uint64_t overlay_pcg(uint64_t dots, uint8_t pat_t, uint8_t pat_b, uint8_t pat_r, uint8_t pat_g, bool pcg_first)
+	{
+		uint64_t mask_t = dot_mask[pat_t];
+		uint64_t mask_p = dot_mask[pat_b | pat_r | pat_g];
+		uint64_t pcg_dots = (dot_mask[pat_b] & (1 * DOT_BYTES)) | (dot_mask[pat_r] & (2 * DOT_BYTES)) | (dot_mask[pat_g] & (4 * DOT_BYTES));
+		
+		if(pcg_first) {
+			// pcg > text
+			return pcg_dots | (dots & ~mask_p);
+		} else {
+			// text_fore > pcg > text_back
+			return (dots & mask_t) | ((pcg_dots | (dots & ~mask_p)) & ~mask_t);
+		}
+	}
+};
+
+#endif
+
@@ -32,6 +32,7 @@ void KEYBOARD::initialize()
 {
 	key_stat = emu->get_key_buffer();
 	column = 0;
+	polled = false;
 	
 	// register event
 	register_frame_event(this);
@@ -41,6 +42,11 @@ void KEYBOARD::write_signal(int id, uint32_t data, uint32_t mask)
 {
 	column = data & 0x0f;
 	update_key();
+	
+	// the monitor checks only the BREAK and SHIFT keys (column 8) while loading the tape
+	if(column < 10 && column != 8) {
+		polled = true;
+	}
 }
 
 void KEYBOARD::event_frame()
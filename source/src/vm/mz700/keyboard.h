@@ -24,6 +24,7 @@ private:
 	
 	const uint8_t* key_stat;
 	uint8_t column;
+	bool polled;
 	void update_key();
 	
 public:
@@ -44,6 +45,14 @@ public:
 	{
 		d_pio = device;
 	}
+	bool is_polled()
+	{
+		return polled;
+	}
+	void clear_polled()
+	{
+		polled = false;
+	}
 };
 
 #endif
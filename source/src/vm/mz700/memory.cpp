@@ -9,8 +9,10 @@
 */
 
 #include "memory.h"
+#include "../datarec.h"
 #include "../i8253.h"
 #include "../i8255.h"
+#include "../z80.h"
 
 #if defined(_PAL)
 #define BLANK_S				128	//  640 / 5 = 128
@@ -32,6 +34,9 @@
 #define VSYNC_S				221
 #define VSYNC_E				223
 #endif
+#if defined(_MZ1500)
+#define HBLANK_PCG_S		170
+#endif
 
 #define EVENT_TEMPO			0
 #define EVENT_BLINK			1
@@ -51,6 +56,14 @@
 #define MEM_BANK_PCG		0x20
 #endif
 
+// 2KB pages with memory wait or memory mapped i/o
+#define SLOW_PAGES_LOW		0x00000003	// 0000H-0FFFH
+#define SLOW_PAGES_HIGH		0x3c000000	// D000H-EFFFH
+
+#if defined(_MZ1500)
+#define IS_PALETTE_PTR(p) ((p) >= palette && (p) < palette + 8)
+#endif
+
 #define SET_BANK(s, e, w, r) { \
 	int sb = (s) >> 11, eb = (e) >> 11; \
 	for(int i = sb; i <= eb; i++) { \
@@ -67,6 +80,13 @@
 	} \
 }
 
+// monitor work area and entries to read the tape
+#define MON_RDINF			0x0027
+#define MON_RDDAT			0x002a
+#define MON_IBUFE			0x10f0	// header buffer (128 bytes)
+#define MON_SIZE			0x1102
+#define MON_DTADR			0x1104
+
 #define DEFAULT_IPLROM_FILE_NAME	"IPL.ROM"
 #define DEFAULT_EXTROM_FILE_NAME	"EXT.ROM"
 #define DEFAULT_XCGROM_FILE_NAME	"XCG.ROM"
@@ -94,10 +114,6 @@ void MEMORY::initialize()
 	memset(font, 0, sizeof(font));
 	memset(rdmy, 0xff, sizeof(rdmy));
 
-	log = new FILEIO();
-	log->Fopen(create_local_path(_T("BLNK.TXT")), FILEIO_READ_WRITE_NEW_ASCII);
-	log->Fflush();
-
 	// load rom images
 	FILEIO* fio = new FILEIO();
 	if (fio->Fopen(create_local_path(_T(IPLROM_FILE_NAME)), FILEIO_READ_BINARY)) {
@@ -108,10 +124,10 @@ void MEMORY::initialize()
 		fio->Fclose();
 	}
 #if defined(_MZ1500)
-	if(fio->Fopen(create_local_path(_T(EXT_FILE_NAME)), FILEIO_READ_BINARY)) {
+	if(fio->Fopen(create_local_path(_T(EXTROM_FILE_NAME)), FILEIO_READ_BINARY)) {
 		fio->Fread(ext, sizeof(ext), 1);
 		fio->Fclose();
-	} else if (fio->Fopen(create_local_path(_T(DEFAULT_EXT_FILE_NAME)), FILEIO_READ_BINARY)) {
+	} else if (fio->Fopen(create_local_path(_T(DEFAULT_EXTROM_FILE_NAME)), FILEIO_READ_BINARY)) {
 		fio->Fread(ext, sizeof(ext), 1);
 		fio->Fclose();
 	}
@@ -144,23 +160,51 @@ void MEMORY::initialize()
 	
 	// init memory map
 	SET_BANK(0x0000, 0xffff, ram, ram);
+	slow_pages = 0;
 	
 	// create pc palette
 	for(int i = 0; i < 8; i++) {
 		palette_pc[i] = RGB_COLOR((i & 2) ? 255 : 0, (i & 4) ? 255 : 0, (i & 1) ? 255 : 0);
 	}
+	
+	// draw all lines at first
+	set_dirty_all();
+#if defined(_MZ700)
+	prev_pcg_active = false;
+#endif
+	prev_scan_line = false;
+#if defined(USE_COLOR_BLENDER)
+	memset(screen_copy, 0, sizeof(screen_copy));
+	prev_color_blender = false;
+#endif
+	prev_screen_buffer = emu->get_screen_buffer(0);
+	redrawn_rows = 0;
+	total_redrawn_rows = 0;
+	raster_count = 0;
+	raster_line = 0;
+	raster_pending = false;
 
 	// register event
 	register_vline_event(this);
+	register_vline_timeline_event(this, EVENT_HBLANK_S, HBLANK_S);
+	register_vline_timeline_event(this, EVENT_BLANK_S, BLANK_S);
+	register_vline_timeline_event(this, EVENT_BLANK_E, BLANK_E);
+	register_vline_timeline_event(this, EVENT_HSYNC_S, HSYNC_S);
+	register_vline_timeline_event(this, EVENT_HSYNC_E, HSYNC_E);
+#if defined(_MZ1500)
+	// memory wait for pcg
+	register_vline_timeline_event(this, EVENT_HBLANK_PCG_S, HBLANK_PCG_S);
+#endif
 	register_event_by_clock(this, EVENT_TEMPO, CPU_CLOCKS / 64, true, NULL);	// 32hz * 2
 	register_event_by_clock(this, EVENT_BLINK, CPU_CLOCKS / 3, true, NULL);	// 1.5hz * 2
 }
 
 void MEMORY::release()
 {
-	log->Fclose();
-	delete log;
-	log = nullptr;
+	if(mzt_buffer != NULL) {
+		free(mzt_buffer);
+		mzt_buffer = NULL;
+	}
 }
 
 void MEMORY::reset()
@@ -194,6 +238,9 @@ void MEMORY::reset()
 		palette[i] = i;
 	}
 #endif
+	update_palette();
+	set_dirty_all();
+	raster_count = 0;
 
 #if defined(USE_ROMDISK)
 	// reset ROM/DISK page selector
@@ -217,26 +264,45 @@ void MEMORY::event_vline(int v, int clock)
 	set_vblank(v >= 200);
 	vsync = (v >= VSYNC_S && v <= VSYNC_E);
 	
-	// hblank / hsync
+	// hblank / hsync (the events are fired by the vline timeline)
 	set_hblank(false);
 	set_blank(false);
-	register_event_by_clock(this, EVENT_HBLANK_S, HBLANK_S	, false, NULL);
-	register_event_by_clock(this, EVENT_BLANK_S	, BLANK_S	, false, NULL);
-	register_event_by_clock(this, EVENT_BLANK_E	, BLANK_E	, false, NULL);
-	register_event_by_clock(this, EVENT_HSYNC_S	, HSYNC_S	, false, NULL);
-	register_event_by_clock(this, EVENT_HSYNC_E	, HSYNC_E	, false, NULL);
 #if defined(_MZ1500)
-	// memory wait for pcg
-	register_event_by_clock(this, EVENT_HBLANK_PCG_S, 170, false, NULL);
 	hblank_pcg = false;
 #endif
 
 	// memory wait for vram
 	blank_vram = false;
 	
-	// draw one line
-	if(v < 200) {
-		draw_line(v);
+	// the writes logged in the previous line for this line
+	int count = 0;
+	for(int i = 0; i < raster_count; i++) {
+		if(raster_log[i].clock >= 228) {
+			raster_log[count] = raster_log[i];
+			raster_log[count++].clock -= 228;
+		}
+	}
+	raster_count = count;
+	raster_line = v;
+	raster_pending = false;
+	
+	// draw one line, or draw the dirty lines later when this frame is shown
+	if(v == 0) {
+		render_skipped = skip_render;
+	}
+	if(v < 200 && !skip_render) {
+		if(config.accurate_raster) {
+			// draw at the blank after the beam passes this line
+			raster_pending = true;
+		} else {
+			draw_line(v);
+		}
+	} else if(v == 200) {
+		// count the character rows drawn in this frame
+		for(uint32_t rows = redrawn_rows; rows != 0; rows &= rows - 1) {
+			total_redrawn_rows++;
+		}
+		redrawn_rows = 0;
 	}
 }
 
@@ -253,6 +319,10 @@ void MEMORY::event_callback(int event_id, int err)
 	} else if(event_id == EVENT_BLANK_S) {
 		set_blank(true);
 		blank_vram = true;
+		if(raster_pending) {
+			draw_raster_line(raster_line);
+			raster_pending = false;
+		}
 	} else if(event_id == EVENT_BLANK_E) {
 		set_blank(false);
 		blank_vram = false;
@@ -283,11 +353,27 @@ void MEMORY::write_data8(uint32_t addr, uint32_t data)
 				d_cpu->write_signal(SIG_CPU_BUSREQ, 1, 1);
 				hblank_pcg = true;
 			}
+			if((pcg_bank & 3) && wbank[addr >> 11][addr & 0x7ff] != data) {
+				set_dirty_all();
+				if(config.accurate_raster) {
+					int clock = int(get_passed_clock_since_vline()) + 2 /* T2 */;
+					log_raster_write(&wbank[addr >> 11][addr & 0x7ff], data, clock < HBLANK_PCG_S ? HBLANK_PCG_S : clock);
+				}
+			}
 		}
 	} else {
 #endif
 		if(mem_bank & MEM_BANK_MON_H) {
-			if(0xe000 <= addr && addr <= 0xe00f) {
+			if(0xd000 <= addr && addr <= 0xdfff) {
+				if(vram[addr & 0xfff] != data) {
+					set_dirty_vram(addr);
+					if(config.accurate_raster) {
+						// the cpu waits for the blank to access vram
+						int clock = int(get_passed_clock_since_vline()) + 2 /* T2 */;
+						log_raster_write(&vram[addr & 0xfff], data, clock < BLANK_S ? BLANK_S : clock < BLANK_E ? clock : 228 + BLANK_S);
+					}
+				}
+			} else if(0xe000 <= addr && addr <= 0xe00f) {
 				// memory mapped i/o
 				switch(addr & 0x0f) {
 				case 0: case 1: case 2: case 3:
@@ -313,7 +399,17 @@ void MEMORY::write_data8(uint32_t addr, uint32_t data)
 				if(!(pcg_ctrl & 0x10) && (data & 0x10)) {
 					int offset = pcg_addr | ((data & 3) << 8);
 					offset |= (data & 4) ? 0xc00 : 0x400;
-					pcg[offset] = (data & 0x20) ? font[offset] : pcg_data;
+					uint8_t value = (data & 0x20) ? font[offset] : pcg_data;
+					if(pcg[offset] != value) {
+						if(config.accurate_raster) {
+							log_raster_write(&pcg[offset], value, int(get_passed_clock_since_vline()) + 2 /* T2 */);
+						}
+						pcg[offset] = value;
+						set_dirty_all();
+					}
+				}
+				if(((pcg_ctrl ^ data) & 8) && config.accurate_raster) {
+					log_raster_write(&pcg_ctrl, data, int(get_passed_clock_since_vline()) + 2 /* T2 */);
 				}
 				pcg_ctrl = data;
 				return;
@@ -383,6 +479,12 @@ void MEMORY::write_data8w(uint32_t addr, uint32_t data, int* wait)
 		else if (BLANK_E <= clocks) {
 			*wait = (228 + BLANK_S) - clocks + 2 - d_cpu->get_tstates() + 2;
 		}
+		OUT_TRACE_LOG(TRACE_MEMORY, _T("WR %04x <- %02x at %d, WAIT: %d\n"), addr, data, clocks, *wait);
+#ifdef Z80_PROFILER
+		if(*wait > 0) {
+			d_cpu->add_debug_profile_wait(*wait);
+		}
+#endif
 	}
 	write_data8(addr, data);
 }
@@ -408,6 +510,12 @@ uint32_t MEMORY::read_data8w(uint32_t addr, int* wait)
 		else if (BLANK_E <= clocks) {
 			*wait = (228 + BLANK_S) - clocks + 2 - d_cpu->get_tstates() + 2;
 		}
+		OUT_TRACE_LOG(TRACE_MEMORY, _T("RD %04x at %d, WAIT: %d\n"), addr, clocks, *wait);
+#ifdef Z80_PROFILER
+		if(*wait > 0) {
+			d_cpu->add_debug_profile_wait(*wait);
+		}
+#endif
 	}
 	return read_data8(addr);
 }
@@ -450,10 +558,23 @@ void MEMORY::write_io8(uint32_t addr, uint32_t data)
 		update_map_high();
 		break;
 	case 0xf0:
-		priority = data;
+		if(priority != data) {
+			if(config.accurate_raster) {
+				log_raster_write(&priority, data, int(get_passed_clock_since_vline()) + 2 /* T2 */);
+			}
+			priority = data;
+			set_dirty_all();
+		}
 		break;
 	case 0xf1:
-		palette[(data >> 4) & 7] = data & 7;
+		if(palette[(data >> 4) & 7] != (data & 7)) {
+			if(config.accurate_raster) {
+				log_raster_write(&palette[(data >> 4) & 7], data & 7, int(get_passed_clock_since_vline()) + 2 /* T2 */);
+			}
+			palette[(data >> 4) & 7] = data & 7;
+			update_palette();
+			set_dirty_all();
+		}
 		break;
 #endif
 	}
@@ -498,8 +619,10 @@ void MEMORY::update_map_low()
 {
 	if(mem_bank & MEM_BANK_MON_L) {
 		SET_BANK(0x0000, 0x0fff, wdmy, ipl);
+		slow_pages |= SLOW_PAGES_LOW;
 	} else {
 		SET_BANK(0x0000, 0x0fff, ram, ram);
+		slow_pages &= ~SLOW_PAGES_LOW;
 	}
 }
 
@@ -531,135 +654,404 @@ void MEMORY::update_map_high()
 		}
 #if defined(_MZ1500)
 	}
+	if(mem_bank & (MEM_BANK_MON_H | MEM_BANK_PCG)) {
+#else
+	if(mem_bank & MEM_BANK_MON_H) {
 #endif
+		slow_pages |= SLOW_PAGES_HIGH;
+	} else {
+		slow_pages &= ~SLOW_PAGES_HIGH;
+	}
 }
 
-void MEMORY::draw_line(int v)
+void MEMORY::set_dirty_vram(uint32_t addr)
+{
+	// text, pcg and attributes of 40x25 characters
+	int row = (addr & 0x3ff) / 40;
+	if(row < 25) {
+		memset(&line_dirty[row * 8], 1, 8);
+	}
+}
+
+uint64_t MEMORY::expand_dots(int v, int ptr, bool pcg_active)
 {
-	int ptr = 40 * (v >> 3);
+	uint8_t attr = vram[ptr | 0x800];
+#if defined(_MZ1500)
+	uint8_t pcg_attr = vram[ptr | 0xc00];
+#endif
 #if defined(_MZ700)
-	bool pcg_active = ((config.dipswitch & 1) && !(pcg_ctrl & 8));
+	uint16_t code = (vram[ptr] << 3) | ((attr & 0x80) << 4) | ((attr & 0x08) << 10);
+#else
+	uint16_t code = (vram[ptr] << 3) | ((attr & 0x80) << 4);
+#endif
+	uint8_t col_b = attr & 7;
+	uint8_t col_f = (attr >> 4) & 7;
+#if defined(_MZ700)
+	uint8_t pat_t = pcg_active ? pcg[code | (v & 7)] : font[code | (v & 7)];
+#else
+	uint8_t pat_t = font[code | (v & 7)];
 #endif
 	
-	for(int x = 0; x < 320; x += 8) {
-		uint8_t attr = vram[ptr | 0x800];
+	// expand 8 dots at once (see dot_expander.h)
+	uint64_t dots = dot_expander.expand_text(pat_t, col_f, col_b);
 #if defined(_MZ1500)
-		uint8_t pcg_attr = vram[ptr | 0xc00];
+	if((priority & 1) && (pcg_attr & 8)) {
+		uint16_t pcg_code = (vram[ptr | 0x400] << 3) | ((pcg_attr & 0xc0) << 5);
+		uint8_t pat_b = pcg[pcg_code | (v & 7) | 0x0000];
+		uint8_t pat_r = pcg[pcg_code | (v & 7) | 0x2000];
+		uint8_t pat_g = pcg[pcg_code | (v & 7) | 0x4000];
+		dots = dot_expander.overlay_pcg(dots, pat_t, pat_b, pat_r, pat_g, (priority & 2) != 0);
+	}
 #endif
+	return dots;
+}
+
+inline bool MEMORY::draw_dots(int v, int x_s, int x_e, scrntype_t* dest)
+{
 #if defined(_MZ700)
-		uint16_t code = (vram[ptr] << 3) | ((attr & 0x80) << 4) | ((attr & 0x08) << 10);
+	bool pcg_active = ((config.dipswitch & 1) && !(pcg_ctrl & 8));
 #else
-		uint16_t code = (vram[ptr] << 3) | ((attr & 0x80) << 4);
+	bool pcg_active = false;
 #endif
-		uint8_t col_b = attr & 7;
-		uint8_t col_f = (attr >> 4) & 7;
+	bool blended = false;
+	
+	for(int x = x_s & ~7; x < x_e; x += 8) {
+		uint64_t dots = expand_dots(v, 40 * (v >> 3) + (x >> 3), pcg_active);
+		uint8_t col[8];
+		memcpy(col, &dots, 8);
+		int i_s = (x < x_s) ? x_s - x : 0;
+		int i_e = (x + 8 > x_e) ? x_e - x : 8;
+		
+		// put 2 dots on the screen buffer for each dot
+#if defined(USE_COLOR_BLENDER)
+		if(config.color_blender) {
+			// average of this frame and the previous frame
+			uint8_t* old = &screen_copy[v][x];
+			for(int i = i_s; i < i_e; i++) {
+				memcpy(dest + (x + i) * 2, palette_blend[col[i]][old[i]], sizeof(scrntype_t) * 2);
+				if(old[i] != col[i]) {
+					old[i] = col[i];
+					blended = true;
+				}
+			}
+		} else {
+#endif
+			for(int i = i_s; i < i_e; i++) {
+				memcpy(dest + (x + i) * 2, palette_dot[col[i]], sizeof(scrntype_t) * 2);
+			}
+#if defined(USE_COLOR_BLENDER)
+		}
+#endif
+	}
+	return blended;
+}
+
+void MEMORY::draw_line(int v)
+{
 #if defined(_MZ700)
-		uint8_t pat_t = pcg_active ? pcg[code | (v & 7)] : font[code | (v & 7)];
-#else
-		uint8_t pat_t = font[code | (v & 7)];
+	bool pcg_active = ((config.dipswitch & 1) && !(pcg_ctrl & 8));
+	if(prev_pcg_active != pcg_active) {
+		prev_pcg_active = pcg_active;
+		set_dirty_all();
+	}
 #endif
-		uint8_t* dest = &screen[v][x];
-		
+	if(prev_scan_line != config.scan_line) {
+		prev_scan_line = config.scan_line;
+		set_dirty_all();
+	}
+#if defined(USE_COLOR_BLENDER)
+	if(prev_color_blender != config.color_blender) {
+		prev_color_blender = config.color_blender;
+		set_dirty_all();
+	}
+#endif
+	
+	// draw only when vram, pcg or the settings are changed since this line was drawn
+	if(!line_dirty[v]) {
+		return;
+	}
+	scrntype_t* dest0 = emu->get_screen_buffer(2 * v);
+	scrntype_t* dest1 = emu->get_screen_buffer(2 * v + 1);
+	if(dest0 == NULL || dest1 == NULL) {
+		// the screen buffer is not created yet
+		return;
+	}
+	line_dirty[v] = false;
+	redrawn_rows |= 1 << (v >> 3);
+	
+	bool blended = draw_dots(v, 0, 320, dest0);
+	if(!config.scan_line) {
+		my_memcpy(dest1, dest0, 640 * sizeof(scrntype_t));
+	} else {
+		memset(dest1, 0, 640 * sizeof(scrntype_t));
+	}
+	if(blended) {
+		// draw again in the next frame to finish blending
+		line_dirty[v] = true;
+	}
+}
+
+void MEMORY::draw_raster_line(int v)
+{
+	if(raster_count == 0) {
+		// nothing is written while the beam passes this line
+		draw_line(v);
+		return;
+	}
+	scrntype_t* dest0 = emu->get_screen_buffer(2 * v);
+	scrntype_t* dest1 = emu->get_screen_buffer(2 * v + 1);
+	if(dest0 != NULL && dest1 != NULL) {
+		// go back to the values at the start of this line
+		uint8_t values[RASTER_LOG_SIZE];
 #if defined(_MZ1500)
-		if((priority & 1) && (pcg_attr & 8)) {
-			uint16_t pcg_code = (vram[ptr | 0x400] << 3) | ((pcg_attr & 0xc0) << 5);
-			uint8_t pcg_dot[8];
-			uint8_t pat_b = pcg[pcg_code | (v & 7) | 0x0000];
-			uint8_t pat_r = pcg[pcg_code | (v & 7) | 0x2000];
-			uint8_t pat_g = pcg[pcg_code | (v & 7) | 0x4000];
-			pcg_dot[0] = ((pat_b & 0x80) >> 7) | ((pat_r & 0x80) >> 6) | ((pat_g & 0x80) >> 5);
-			pcg_dot[1] = ((pat_b & 0x40) >> 6) | ((pat_r & 0x40) >> 5) | ((pat_g & 0x40) >> 4);
-			pcg_dot[2] = ((pat_b & 0x20) >> 5) | ((pat_r & 0x20) >> 4) | ((pat_g & 0x20) >> 3);
-			pcg_dot[3] = ((pat_b & 0x10) >> 4) | ((pat_r & 0x10) >> 3) | ((pat_g & 0x10) >> 2);
-			pcg_dot[4] = ((pat_b & 0x08) >> 3) | ((pat_r & 0x08) >> 2) | ((pat_g & 0x08) >> 1);
-			pcg_dot[5] = ((pat_b & 0x04) >> 2) | ((pat_r & 0x04) >> 1) | ((pat_g & 0x04) >> 0);
-			pcg_dot[6] = ((pat_b & 0x02) >> 1) | ((pat_r & 0x02) >> 0) | ((pat_g & 0x02) << 1);
-			pcg_dot[7] = ((pat_b & 0x01) >> 0) | ((pat_r & 0x01) << 1) | ((pat_g & 0x01) << 2);
-			
-			if(priority & 2) {
-				// pcg > text
-				dest[0] = pcg_dot[0] ? pcg_dot[0] : (pat_t & 0x80) ? col_f : col_b;
-				dest[1] = pcg_dot[1] ? pcg_dot[1] : (pat_t & 0x40) ? col_f : col_b;
-				dest[2] = pcg_dot[2] ? pcg_dot[2] : (pat_t & 0x20) ? col_f : col_b;
-				dest[3] = pcg_dot[3] ? pcg_dot[3] : (pat_t & 0x10) ? col_f : col_b;
-				dest[4] = pcg_dot[4] ? pcg_dot[4] : (pat_t & 0x08) ? col_f : col_b;
-				dest[5] = pcg_dot[5] ? pcg_dot[5] : (pat_t & 0x04) ? col_f : col_b;
-				dest[6] = pcg_dot[6] ? pcg_dot[6] : (pat_t & 0x02) ? col_f : col_b;
-				dest[7] = pcg_dot[7] ? pcg_dot[7] : (pat_t & 0x01) ? col_f : col_b;
-			} else {
-				// text_fore > pcg > text_back
-				dest[0] = (pat_t & 0x80) ? col_f : pcg_dot[0] ? pcg_dot[0] : col_b;
-				dest[1] = (pat_t & 0x40) ? col_f : pcg_dot[1] ? pcg_dot[1] : col_b;
-				dest[2] = (pat_t & 0x20) ? col_f : pcg_dot[2] ? pcg_dot[2] : col_b;
-				dest[3] = (pat_t & 0x10) ? col_f : pcg_dot[3] ? pcg_dot[3] : col_b;
-				dest[4] = (pat_t & 0x08) ? col_f : pcg_dot[4] ? pcg_dot[4] : col_b;
-				dest[5] = (pat_t & 0x04) ? col_f : pcg_dot[5] ? pcg_dot[5] : col_b;
-				dest[6] = (pat_t & 0x02) ? col_f : pcg_dot[6] ? pcg_dot[6] : col_b;
-				dest[7] = (pat_t & 0x01) ? col_f : pcg_dot[7] ? pcg_dot[7] : col_b;
+		bool palette_logged = false;
+#endif
+		for(int i = raster_count - 1; i >= 0; i--) {
+			values[i] = *raster_log[i].ptr;
+			*raster_log[i].ptr = raster_log[i].old_value;
+#if defined(_MZ1500)
+			palette_logged |= IS_PALETTE_PTR(raster_log[i].ptr);
+#endif
+		}
+#if defined(_MZ1500)
+		// the palette colors are updated only when the palette is written in this line
+		if(palette_logged) {
+			update_palette();
+		}
+#endif
+		// draw the dots until the beam position of each write,
+		// the writes after the display period are not shown in this line
+		int x = 0;
+		for(int i = 0; i < raster_count; i++) {
+			if(raster_log[i].clock < BLANK_S) {
+				int next_x = raster_log[i].clock * 320 / BLANK_S;
+				if(x < next_x) {
+					draw_dots(v, x, next_x, dest0);
+					x = next_x;
+				}
+				*raster_log[i].ptr = raster_log[i].new_value;
+#if defined(_MZ1500)
+				if(IS_PALETTE_PTR(raster_log[i].ptr)) {
+					update_palette();
+				}
+#endif
 			}
+		}
+		if(x < 320) {
+			draw_dots(v, x, 320, dest0);
+		}
+		if(!config.scan_line) {
+			my_memcpy(dest1, dest0, 640 * sizeof(scrntype_t));
 		} else {
-#endif
-			// text only
-			dest[0] = (pat_t & 0x80) ? col_f : col_b;
-			dest[1] = (pat_t & 0x40) ? col_f : col_b;
-			dest[2] = (pat_t & 0x20) ? col_f : col_b;
-			dest[3] = (pat_t & 0x10) ? col_f : col_b;
-			dest[4] = (pat_t & 0x08) ? col_f : col_b;
-			dest[5] = (pat_t & 0x04) ? col_f : col_b;
-			dest[6] = (pat_t & 0x02) ? col_f : col_b;
-			dest[7] = (pat_t & 0x01) ? col_f : col_b;
+			memset(dest1, 0, 640 * sizeof(scrntype_t));
+		}
+		redrawn_rows |= 1 << (v >> 3);
+		
+		// restore the current values
+		for(int i = 0; i < raster_count; i++) {
+			*raster_log[i].ptr = values[i];
+		}
 #if defined(_MZ1500)
+		if(palette_logged) {
+			update_palette();
 		}
 #endif
-		ptr++;
+		// draw again in the next frame with the values at that time
+		line_dirty[v] = true;
+	}
+	
+	// remove the writes in this line
+	int count = 0;
+	for(int i = 0; i < raster_count; i++) {
+		if(raster_log[i].clock >= 228) {
+			raster_log[count++] = raster_log[i];
+		}
+	}
+	raster_count = count;
+}
+
+void MEMORY::log_raster_write(uint8_t* ptr, uint8_t value, int clock)
+{
+	// log only when the line that the write is shown is not drawn yet
+	if(clock < 228) {
+		if(!raster_pending) {
+			return;
+		}
+	} else if(skip_render || (raster_line + 1) % LINES_PER_FRAME >= 200) {
+		return;
+	}
+	if(raster_count < RASTER_LOG_SIZE) {
+		raster_log[raster_count].ptr = ptr;
+		raster_log[raster_count].old_value = *ptr;
+		raster_log[raster_count].new_value = value;
+		raster_log[raster_count].clock = clock;
+		raster_count++;
 	}
 }
 
 void MEMORY::draw_screen()
 {
-	if(emu->now_waiting_in_debugger) {
+	// the lines are already drawn into the screen buffer by draw_line()
+	emu->set_vm_screen_lines(200);
+	
+	if(prev_screen_buffer != emu->get_screen_buffer(0)) {
+		// the screen buffer is created again
+		prev_screen_buffer = emu->get_screen_buffer(0);
+		set_dirty_all();
+		for(int v = 0; v < 200; v++) {
+			draw_line(v);
+		}
+	} else if(emu->now_waiting_in_debugger || render_skipped) {
 		// draw lines
 		for(int v = 0; v < 200; v++) {
 			draw_line(v);
 		}
+		render_skipped = false;
 	}
-	
-	// copy to real screen
-	emu->set_vm_screen_lines(200);
-	
-	for(int y = 0; y < 200; y++) {
-		scrntype_t* dest0 = emu->get_screen_buffer(2 * y);
-		scrntype_t* dest1 = emu->get_screen_buffer(2 * y + 1);
-		uint8_t* old = screen_copy[y];
-		uint8_t* src = screen[y];
-		
-		for(int x = 0, x2 = 0; x < 320; x++, x2 += 2) {
+	emu->screen_skip_line(true);
+}
+
+void MEMORY::update_palette()
+{
+	for(int i = 0; i < 8; i++) {
 #if defined(_MZ1500)
-			dest0[x2] = dest0[x2 + 1] = palette_pc[palette[src[x] & 7]];
+		palette_dot[i][0] = palette_dot[i][1] = palette_pc[palette[i]];
 #else
-			if (config.color_blender) {
-				dest0[x2] = dest0[x2 + 1] = (palette_pc[src[x] & 7] & RGB_COLOR(0x7F, 0x7F, 0x7F)) + (palette_pc[old[x] & 7] & RGB_COLOR(0x7F, 0x7F, 0x7F));
-			} else {
-				dest0[x2] = dest0[x2 + 1] = (palette_pc[src[x] & 7]);
-			}
+		palette_dot[i][0] = palette_dot[i][1] = palette_pc[i];
 #endif
+	}
+#if defined(USE_COLOR_BLENDER)
+	for(int i = 0; i < 8; i++) {
+		for(int j = 0; j < 8; j++) {
+			palette_blend[i][j][0] = palette_blend[i][j][1] = (palette_pc[i] & RGB_COLOR(0x7F, 0x7F, 0x7F)) + (palette_pc[j] & RGB_COLOR(0x7F, 0x7F, 0x7F));
 		}
-		if(!config.scan_line) {
-			my_memcpy(dest1, dest0, 640 * sizeof(scrntype_t));
-			if (config.color_blender) {
-				my_memcpy(old, src, 320 * sizeof(uint8_t));
+	}
+#endif
+}
+
+// ----------------------------------------------------------------------------
+// direct load of mzt image
+// ----------------------------------------------------------------------------
+
+void MEMORY::open_mzt(const _TCHAR* file_path)
+{
+	close_mzt();
+	
+	FILEIO* fio = new FILEIO();
+	if(fio->Fopen(file_path, FILEIO_READ_BINARY)) {
+		fio->Fseek(0, FILEIO_SEEK_END);
+		int length = fio->Ftell();
+		fio->Fseek(0, FILEIO_SEEK_SET);
+		if(length >= 128) {
+			mzt_buffer = (uint8_t *)malloc(length);
+			fio->Fread(mzt_buffer, length, 1);
+			mzt_length = length;
+		}
+		fio->Fclose();
+	}
+	delete fio;
+	update_mzt_bios();
+}
+
+void MEMORY::close_mzt()
+{
+	if(mzt_buffer != NULL) {
+		free(mzt_buffer);
+		mzt_buffer = NULL;
+	}
+	mzt_length = mzt_ptr = 0;
+	mzt_header_loaded = false;
+	update_mzt_bios();
+}
+
+void MEMORY::update_mzt_bios()
+{
+	// restore the monitor
+	if(mzt_bios_patched) {
+		for(int i = 1; i >= 0; i--) {
+			ipl[mzt_bios_addr[i]] = mzt_bios_code[i];
+		}
+		mzt_bios_patched = false;
+	}
+	
+	// replace RDINF and RDDAT with RET while the image has any file to load,
+	// and the non-standard loaders read the tape signal after all files are loaded
+	if(mzt_buffer != NULL && (mzt_header_loaded || mzt_ptr + 128 <= mzt_length)) {
+		// the routines are patched instead of the entries, because the monitor
+		// itself calls them directly. the unknown monitor is not patched
+		static const uint16_t entry[2] = {MON_RDINF, MON_RDDAT};
+		for(int i = 0; i < 2; i++) {
+			mzt_bios_addr[i] = ipl[entry[i] + 1] | (ipl[entry[i] + 2] << 8);
+		}
+		if(ipl[MON_RDINF] == 0xc3 && ipl[MON_RDDAT] == 0xc3 && mzt_bios_addr[0] != mzt_bios_addr[1] &&
+		   mzt_bios_addr[0] < sizeof(ipl) && mzt_bios_addr[1] < sizeof(ipl)) {
+			for(int i = 0; i < 2; i++) {
+				mzt_bios_code[i] = ipl[mzt_bios_addr[i]];
+				ipl[mzt_bios_addr[i]] = 0xc9;
 			}
+			mzt_bios_patched = true;
+		}
+	}
+#ifdef Z80_BLOCK_CACHE
+	d_cpu->write_signal(SIG_Z80_BLOCK_CACHE_FLUSH, 1, 1);
+#endif
+}
+
+bool MEMORY::bios_ret_z80(uint16_t PC, pair32_t* af, pair32_t* bc, pair32_t* de, pair32_t* hl, pair32_t* ix, pair32_t* iy, uint8_t* iff1)
+{
+	// the patched RET in the monitor is executed
+	if(!mzt_bios_patched || PC >= sizeof(ipl) || rbank[PC >> 11] + (PC & 0x7ff) != ipl + PC) {
+		return false;
+	}
+	if(PC == mzt_bios_addr[0]) {
+		// RDINF: read the header into IBUFE
+		if(mzt_ptr + 128 <= mzt_length) {
+			if(d_drec != NULL) {
+				if(mzt_header_loaded) {
+					// skip the body of the previous file
+					d_drec->skip_to_next_gap();
+				}
+				d_drec->skip_to_next_gap();
+			}
+			for(int i = 0; i < 128; i++) {
+				ram[MON_IBUFE + i] = mzt_buffer[mzt_ptr + i];
+			}
+			mzt_body_ptr = mzt_ptr + 128;
+			mzt_body_size = min(mzt_buffer[mzt_ptr + 0x12] | (mzt_buffer[mzt_ptr + 0x13] << 8), mzt_length - mzt_body_ptr);
+			mzt_ptr = mzt_body_ptr + mzt_body_size;
+			mzt_header_loaded = true;
+			af->b.l &= ~0x01;	// CF=0
 		} else {
-			memset(dest1, 0, 640 * sizeof(scrntype_t));
-			if (config.color_blender) {
-				my_memcpy(old, src, 320 * sizeof(uint8_t));
+			af->b.h = 2;		// break
+			af->b.l |= 0x01;	// CF=1
+		}
+	} else if(PC == mzt_bios_addr[1]) {
+		// RDDAT: read SIZE bytes into DTADR
+		if(mzt_header_loaded) {
+			if(d_drec != NULL) {
+				d_drec->skip_to_next_gap();
+			}
+			int size = min(ram[MON_SIZE] | (ram[MON_SIZE + 1] << 8), mzt_body_size);
+			uint16_t addr = ram[MON_DTADR] | (ram[MON_DTADR + 1] << 8);
+			for(int i = 0; i < size; i++, addr++) {
+				wbank[addr >> 11][addr & 0x7ff] = mzt_buffer[mzt_body_ptr + i];
 			}
+			// the image may be loaded into vram
+			set_dirty_all();
+			mzt_header_loaded = false;
+			af->b.l &= ~0x01;	// CF=0
+		} else {
+			af->b.h = 1;		// check sum error
+			af->b.l |= 0x01;	// CF=1
 		}
+	} else {
+		return false;
 	}
-	emu->screen_skip_line(true);
+	update_mzt_bios();
+	return true;
 }
 
-#define STATE_VERSION	3
+#define STATE_VERSION	4
 
 bool MEMORY::process_state(FILEIO* state_fio, bool loading)
 {
@@ -710,11 +1102,36 @@ bool MEMORY::process_state(FILEIO* state_fio, bool loading)
 	state_fio->StateValue(ipl_page);
 	state_fio->StateValue(ipl_storage);
 #endif
+	
+	// direct load of mzt image
+	if(loading) {
+		if(mzt_buffer != NULL) {
+			free(mzt_buffer);
+			mzt_buffer = NULL;
+		}
+		if((mzt_length = state_fio->FgetInt32_LE()) != 0) {
+			mzt_buffer = (uint8_t *)malloc(mzt_length);
+			state_fio->Fread(mzt_buffer, mzt_length, 1);
+		}
+	} else {
+		state_fio->FputInt32_LE(mzt_length);
+		if(mzt_length != 0) {
+			state_fio->Fwrite(mzt_buffer, mzt_length, 1);
+		}
+	}
+	state_fio->StateValue(mzt_ptr);
+	state_fio->StateValue(mzt_body_ptr);
+	state_fio->StateValue(mzt_body_size);
+	state_fio->StateValue(mzt_header_loaded);
 
 	// post process
 	if(loading) {
 		update_map_low();
 		update_map_high();
+		update_mzt_bios();
+		update_palette();
+		set_dirty_all();
+		raster_count = 0;
 	}
 	return true;
 }
@@ -14,12 +14,18 @@
 #include "../vm.h"
 #include "../../emu.h"
 #include "../device.h"
+#include "dot_expander.h"
+
+class DATAREC;
+
+#define RASTER_LOG_SIZE		256
 
 class MEMORY : public DEVICE
 {
 private:
 	DEVICE *d_cpu, *d_pit, *d_pio;
 	DEVICE* d_joystick;
+	DATAREC* d_drec;
 #if defined(USE_ROMDISK)
 	DEVICE* d_romdisk[1];
 #endif
@@ -29,6 +35,7 @@ private:
 	uint8_t* wbank[32];
 	uint8_t wdmy[0x800];
 	uint8_t rdmy[0x800];
+	uint32_t slow_pages;	// pages that cpu should access with read_data8w/write_data8w
 	
 	uint8_t ipl[0x1000];	// IPL 4KB
 #if defined(_MZ1500)
@@ -57,6 +64,18 @@ private:
 	void update_map_low();
 	void update_map_high();
 	
+	// direct load of mzt image
+	// RDINF and RDDAT of the monitor are replaced with RET, and bios_ret_z80
+	// copies the header and the body from the image into ram
+	uint8_t* mzt_buffer;
+	int mzt_length, mzt_ptr;
+	int mzt_body_ptr, mzt_body_size;
+	bool mzt_header_loaded;
+	uint16_t mzt_bios_addr[2];
+	uint8_t mzt_bios_code[2];
+	bool mzt_bios_patched;
+	void update_mzt_bios();
+	
 	// crtc
 #if defined(_MZ1500)
 	uint8_t priority, palette[8];
@@ -73,18 +92,67 @@ private:
 	void set_hblank(bool val);
 	void set_blank(bool val);
 
-	// renderer
-	uint8_t screen[200][320];
+	// renderer (draw_line() draws into the screen buffer directly)
+#if defined(USE_COLOR_BLENDER)
 	uint8_t screen_copy[200][320];
+#endif
 	scrntype_t palette_pc[8];
+	bool skip_render, render_skipped;
 	
-	FILEIO* log = nullptr;
-
+	// 2 dots on the screen buffer for each color
+	scrntype_t palette_dot[8][2];
+#if defined(USE_COLOR_BLENDER)
+	scrntype_t palette_blend[8][8][2];
+#endif
+	void update_palette();
+	
+	// lines to draw again by draw_line()
+	bool line_dirty[200];
+#if defined(_MZ700)
+	bool prev_pcg_active;
+#endif
+	bool prev_scan_line;
+#if defined(USE_COLOR_BLENDER)
+	bool prev_color_blender;
+#endif
+	scrntype_t* prev_screen_buffer;
+	uint32_t redrawn_rows;
+	uint64_t total_redrawn_rows;
+	void set_dirty_vram(uint32_t addr);
+	void set_dirty_all()
+	{
+		memset(line_dirty, 1, sizeof(line_dirty));
+	}
+	
+	// accurate raster (the writes to vram, pcg and palette are logged with
+	// the beam position, and the line is drawn at the blank with the values
+	// that are changed while the beam is passing)
+	typedef struct {
+		uint8_t* ptr;
+		uint8_t old_value, new_value;
+		int clock;	// clocks since the start of current line
+	} raster_write_t;
+	raster_write_t raster_log[RASTER_LOG_SIZE];
+	int raster_count;
+	int raster_line;
+	bool raster_pending;
+	void log_raster_write(uint8_t* ptr, uint8_t value, int clock);
+	void draw_raster_line(int v);
+	
+	DOT_EXPANDER dot_expander;
+	uint64_t expand_dots(int v, int ptr, bool pcg_active);
+	bool draw_dots(int v, int x_s, int x_e, scrntype_t* dest);
 	void draw_line(int v);
 	
 public:
 	MEMORY(VM_TEMPLATE* parent_vm, EMU* parent_emu) : DEVICE(parent_vm, parent_emu)
 	{
+		d_drec = NULL;
+		mzt_buffer = NULL;
+		mzt_length = mzt_ptr = 0;
+		mzt_body_ptr = mzt_body_size = 0;
+		mzt_header_loaded = mzt_bios_patched = false;
+		skip_render = render_skipped = false;
 		set_device_name(_T("Memory Bus"));
 	}
 	~MEMORY() {}
@@ -104,6 +172,7 @@ public:
 	uint32_t read_data8w(uint32_t addr, int* wait);
 	void write_io8(uint32_t addr, uint32_t data);
 	uint32_t read_io8(uint32_t addr);
+	bool bios_ret_z80(uint16_t PC, pair32_t* af, pair32_t* bc, pair32_t* de, pair32_t* hl, pair32_t* ix, pair32_t* iy, uint8_t* iff1);
 	bool process_state(FILEIO* state_fio, bool loading);
 	
 	// unique functions
@@ -119,6 +188,10 @@ public:
 	{
 		d_pio = device;
 	}
+	void set_context_drec(DATAREC* device)
+	{
+		d_drec = device;
+	}
 #if defined(USE_ROMDISK)
 	void set_context_romdisk(int i, DEVICE* device)
 	{
@@ -127,7 +200,29 @@ public:
 		}
 	}
 #endif
+	uint8_t** get_read_bank()
+	{
+		return rbank;
+	}
+	uint8_t** get_write_bank()
+	{
+		return wbank;
+	}
+	uint32_t* get_slow_pages()
+	{
+		return &slow_pages;
+	}
 	void draw_screen();
+	void set_skip_render(bool value)
+	{
+		skip_render = value;
+	}
+	uint64_t get_total_redrawn_rows()
+	{
+		return total_redrawn_rows;
+	}
+	void open_mzt(const _TCHAR* file_path);
+	void close_mzt();
 };
 
 #endif
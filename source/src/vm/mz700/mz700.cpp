@@ -137,6 +137,9 @@ VM::VM(EMU* parent_emu) : VM_TEMPLATE(parent_emu)
 	// memory mapped I/O
 	memory->set_context_pio(pio);
 	memory->set_context_pit(pit);
+	
+	// direct load of mzt image
+	memory->set_context_drec(drec);
 
 #if defined(USE_ROMDISK)
 	// rom disks
@@ -263,6 +266,8 @@ VM::VM(EMU* parent_emu) : VM_TEMPLATE(parent_emu)
 	// cpu bus
 	cpu->set_context_mem(memory);
 	cpu->set_context_io(io);
+	cpu->set_memory_page_table(memory->get_read_bank(), memory->get_write_bank(), memory->get_slow_pages());
+	cpu->set_context_bios(memory);
 #if defined(_MZ1500)
 	cpu->set_context_intr(pio_int);
 	// z80 family daisy chain
@@ -336,6 +341,8 @@ VM::VM(EMU* parent_emu) : VM_TEMPLATE(parent_emu)
 	for(DEVICE* device = first_device; device; device = device->next_device) {
 		device->initialize();
 	}
+	tape_motor = tape_turbo = false;
+	render_demand = true;
 #if defined(_MZ1500)
 	for(int drv = 0; drv < MAX_DRIVE; drv++) {
 //		if(config.drive_type) {
@@ -388,9 +395,45 @@ void VM::reset()
 
 void VM::run()
 {
+	update_tape_turbo();
+	memory->set_skip_render(tape_turbo || !render_demand);
 	event->drive();
 }
 
+void VM::update_tape_turbo()
+{
+	// start when the cassette motor is turned on, and stop when it is turned off
+	// or the program scans the keyboard
+	bool motor = drec->is_tape_playing();
+	if(motor && !tape_motor) {
+		keyboard->clear_polled();
+	}
+	tape_motor = motor;
+	
+	bool value = (config.tape_turbo && motor && !keyboard->is_polled());
+	tape_turbo = value;
+}
+
+void VM::set_render_demand(bool value)
+{
+	render_demand = value;
+}
+
+uint64_t VM::get_total_cpu_clocks()
+{
+	return event->get_total_cpu_clocks();
+}
+
+uint64_t VM::get_total_fired_events()
+{
+	return event->get_total_fired_events();
+}
+
+uint64_t VM::get_total_redrawn_rows()
+{
+	return memory->get_total_redrawn_rows();
+}
+
 // ----------------------------------------------------------------------------
 // debugger
 // ----------------------------------------------------------------------------
@@ -425,9 +468,12 @@ void VM::initialize_sound(int rate, int samples)
 	
 	// init sound gen
 	pcm->initialize_sound(rate, 8000);
+	pcm->set_band_limited(config.sound_band_limited);
 #if defined(_MZ1500)
 	psg_l->initialize_sound(rate, 3579545, 8000);
 	psg_r->initialize_sound(rate, 3579545, 8000);
+	psg_l->set_band_limited(config.sound_band_limited);
+	psg_r->set_band_limited(config.sound_band_limited);
 #endif
 }
 
@@ -441,6 +487,16 @@ int VM::get_sound_buffer_ptr()
 	return event->get_sound_buffer_ptr();
 }
 
+bool VM::start_record_sound_stems(SOUND_WRITER* writer, const _TCHAR* prefix)
+{
+	return event->start_record_sound_stems(writer, prefix);
+}
+
+void VM::stop_record_sound_stems()
+{
+	event->stop_record_sound_stems();
+}
+
 #ifdef USE_SOUND_VOLUME
 void VM::set_sound_device_volume(int ch, int decibel_l, int decibel_r)
 {
@@ -481,12 +537,19 @@ void VM::play_tape(int drv, const _TCHAR* file_path)
 		// if machine already sets remote on, start playing now
 		push_play(drv);
 	}
+	if(config.direct_load_mzt[drv] && drec->is_tape_inserted() && (check_file_extension(file_path, _T(".mzt")) || check_file_extension(file_path, _T(".mzf")) || check_file_extension(file_path, _T(".m12")))) {
+		// the monitor loads the files in the image without the tape signal
+		memory->open_mzt(file_path);
+	} else {
+		memory->close_mzt();
+	}
 }
 
 void VM::rec_tape(int drv, const _TCHAR* file_path)
 {
 	bool remote = drec->get_remote();
 	
+	memory->close_mzt();
 	if(drec->rec_tape(file_path) && remote) {
 		// if machine already sets remote on, start recording now
 		push_play(drv);
@@ -497,6 +560,7 @@ void VM::close_tape(int drv)
 {
 	emu->lock_vm();
 	drec->close_tape();
+	memory->close_mzt();
 	emu->unlock_vm();
 	drec->set_remote(false);
 }
@@ -624,7 +688,8 @@ uint32_t VM::is_floppy_disk_accessed()
 
 bool VM::is_frame_skippable()
 {
-	return event->is_frame_skippable();
+	bool value = event->is_frame_skippable();
+	return (value || tape_turbo);
 }
 
 void VM::update_config()
@@ -632,6 +697,11 @@ void VM::update_config()
 	for(DEVICE* device = first_device; device; device = device->next_device) {
 		device->update_config();
 	}
+	pcm->set_band_limited(config.sound_band_limited);
+#if defined(_MZ1500)
+	psg_l->set_band_limited(config.sound_band_limited);
+	psg_r->set_band_limited(config.sound_band_limited);
+#endif
 }
 
 #define STATE_VERSION	3
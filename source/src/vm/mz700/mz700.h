@@ -36,6 +36,16 @@
 #define IO_ADDR_MAX		0x100
 #define Z80_MEMORY_WAIT
 #define Z80_IO_WAIT
+#define Z80_MEMORY_PAGE_TABLE
+#define Z80_BATCH_EXTRA_EVENT
+#define Z80_BLOCK_CACHE
+// record all opecodes into the ring buffer to dump with UTW command
+//#define Z80_EXEC_TRACE
+// count the clocks per function to write the report with PFW command
+//#define Z80_PROFILER
+// count the memory accesses per address to write the heatmap with MHW command
+//#define Z80_MEMORY_HEATMAP
+#define Z80_PSEUDO_BIOS
 #if defined(_MZ1500)
 #define MAX_DRIVE		4
 #define HAS_MB8876
@@ -62,11 +72,13 @@
 #define USE_VM_AUTO_KEY_TABLE
 #define USE_SCREEN_FILTER
 #define USE_SCANLINE
+#define USE_ACCURATE_RASTER
 #if defined(_MZ700)
 #define USE_SOUND_VOLUME	3
 #elif defined(_MZ1500)
 #define USE_SOUND_VOLUME	6
 #endif
+#define USE_BAND_LIMITED_SOUND
 #if defined(_MZ1500)
 #define USE_PRINTER
 #define USE_PRINTER_TYPE	4
@@ -147,7 +159,7 @@ static const int vm_auto_key_table_base[][2] = {
 #include "../vm_template.h"
 
 #ifdef USE_SOUND_VOLUME
-static const _TCHAR *sound_device_caption[] = {
+static const _TCHAR *const sound_device_caption[] = {
 #if defined(_MZ1500)
 	_T("PSG #1"), _T("PSG #2"),
 #endif
@@ -250,6 +262,13 @@ protected:
 #endif
 	JOYSTICK* joystick;
 	
+	// run at full speed while loading the tape
+	bool tape_motor, tape_turbo;
+	void update_tape_turbo();
+	
+	// the screen is not drawn in the frames that are not shown
+	bool render_demand;
+	
 public:
 	// ----------------------------------------
 	// initialize
@@ -265,10 +284,14 @@ public:
 	// drive virtual machine
 	void reset();
 	void run();
+	void set_render_demand(bool value);
 	double get_frame_rate()
 	{
 		return FRAMES_PER_SEC;
 	}
+	uint64_t get_total_cpu_clocks();
+	uint64_t get_total_fired_events();
+	uint64_t get_total_redrawn_rows();
 	
 #ifdef USE_DEBUGGER
 	// debugger
@@ -282,6 +305,8 @@ public:
 	void initialize_sound(int rate, int samples);
 	uint16_t* create_sound(int* extra_frames);
 	int get_sound_buffer_ptr();
+	bool start_record_sound_stems(SOUND_WRITER* writer, const _TCHAR* prefix);
+	void stop_record_sound_stems();
 #ifdef USE_SOUND_VOLUME
 	void set_sound_device_volume(int ch, int decibel_l, int decibel_r);
 #endif
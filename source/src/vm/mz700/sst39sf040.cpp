@@ -27,16 +27,6 @@ void SST39SF040::initialize()
 		fio->Fclose();
 	}
 	delete fio;
-
-	if (false) {
-		log = new FILEIO();
-		log->Fopen(create_local_path(_T("SST39SF040.TXT")), FILEIO_READ_WRITE_NEW_ASCII);
-		log->Fprintf("%s\n", __func__);
-		log->Fflush();
-	}
-	else {
-		log = 0;
-	}
 }
 
 void SST39SF040::release()
@@ -52,13 +42,6 @@ void SST39SF040::release()
 	
 	// release memory
 	free(data_buffer);
-
-	if (log) {
-		log->Fprintf("%s\n", __func__);
-		log->Fclose();
-		delete log;
-		log = 0;
-	}
 }
 
 void SST39SF040::reset()
@@ -70,7 +53,7 @@ void SST39SF040::reset()
 
 void SST39SF040::write_data8(uint32_t addr, uint32_t data)
 {
-	if (log) log->Fprintf("WR 0x%08x <- 0x%02x (MS:%d)\n", addr, data, wc);
+	OUT_TRACE_LOG(TRACE_FLASH, _T("WR 0x%08x <- 0x%02x (MS:%d)\n"), addr, data, wc);
 	if (busy) {
 		return;
 	}
@@ -98,8 +81,7 @@ void SST39SF040::write_data8(uint32_t addr, uint32_t data)
 		case 0x555590:
 			software_id_entry = true;
 			wc = WC1_XXXXYY;
-			if (log) log->Fprintf("EX SOFTWARE ID ENTRY\n");
-			if (log) log->Fflush();
+			OUT_TRACE_LOG(TRACE_FLASH, _T("EX SOFTWARE ID ENTRY\n"));
 			break;
 		case 0x5555A0:
 			wc = WC3_5555A0;
@@ -107,8 +89,7 @@ void SST39SF040::write_data8(uint32_t addr, uint32_t data)
 		case 0x5555F0:
 			software_id_entry = false;
 			wc = WC1_XXXXYY;
-			if (log) log->Fprintf("EX SOFTWARE ID EXIT\n");
-			if (log) log->Fflush();
+			OUT_TRACE_LOG(TRACE_FLASH, _T("EX SOFTWARE ID EXIT\n"));
 			break;
 		default:
 			wc = WC1_XXXXYY;
@@ -132,8 +113,7 @@ void SST39SF040::write_data8(uint32_t addr, uint32_t data)
 		else if (data == 0xF0) {
 			software_id_entry = false;
 			wc = WC1_XXXXYY;
-			if (log) log->Fprintf("EX SOFTWARE ID EXIT\n");
-			if (log) log->Fflush();
+			OUT_TRACE_LOG(TRACE_FLASH, _T("EX SOFTWARE ID EXIT\n"));
 			break;
 		}
 		break;
@@ -143,8 +123,7 @@ void SST39SF040::write_data8(uint32_t addr, uint32_t data)
 		data_buffer[addr & ADDR_MASK] = uint8_t(data);
 		busy = 4;
 		wc = WC1_XXXXYY;
-		if (log) log->Fprintf("EX BYTE-PROGRAM: [0x%08x] = 0x%02x\n", addr, data);
-		if (log) log->Fflush();
+		OUT_TRACE_LOG(TRACE_FLASH, _T("EX BYTE-PROGRAM: [0x%08x] = 0x%02x\n"), addr, data);
 		break;
 
 	case WC4_5555AA:
@@ -161,8 +140,7 @@ void SST39SF040::write_data8(uint32_t addr, uint32_t data)
 			memset(data_buffer, 0xFF, DATA_SIZE);
 			modified = true;
 			wc = WC1_XXXXYY;
-			if (log) log->Fprintf("EX CHIP-ERASE\n");
-			if (log) log->Fflush();
+			OUT_TRACE_LOG(TRACE_FLASH, _T("EX CHIP-ERASE\n"));
 			break;
 		}
 		else if (data == 0x30) {
@@ -170,8 +148,7 @@ void SST39SF040::write_data8(uint32_t addr, uint32_t data)
 			memset(data_buffer+(addr & (ADDR_MASK ^ 0x0FFF)), 0xFF, 0x1000);
 			modified = true;
 			wc = WC1_XXXXYY;
-			if (log) log->Fprintf("EX SECTOR-ERASE: 0x%08x\n", addr);
-			if (log) log->Fflush();
+			OUT_TRACE_LOG(TRACE_FLASH, _T("EX SECTOR-ERASE: 0x%08x\n"), addr);
 			break;
 		}
 		wc = WC1_XXXXYY;
@@ -184,27 +161,24 @@ uint32_t SST39SF040::read_data8(uint32_t addr)
 	uint32_t byte = uint32_t(data_buffer[addr & ADDR_MASK]);
 	if (busy) {
 		uint32_t result = (byte ^ 0x80) ^ ((--busy & 1) << 6);
-		if (log) log->Fprintf("RD 0x%08x -> 0x%02x (0x%02x), BUSY: %d\n", addr, result, byte, busy);
+		OUT_TRACE_LOG(TRACE_FLASH, _T("RD 0x%08x -> 0x%02x (0x%02x), BUSY: %d\n"), addr, result, byte, busy);
 		return result;
 	}
 	if (software_id_entry) {
 		switch (addr) {
 		case 0:
-			if (log) log->Fprintf("RD 0x%08x -> 0xBF (SIE mode)\n", addr);
-			if (log) log->Fflush();
+			OUT_TRACE_LOG(TRACE_FLASH, _T("RD 0x%08x -> 0xBF (SIE mode)\n"), addr);
 			return 0xBF;
 		case 1:
-			if (log) log->Fprintf("RD 0x%08x -> 0xB7 (SIE mode)\n", addr);
-			if (log) log->Fflush();
+			OUT_TRACE_LOG(TRACE_FLASH, _T("RD 0x%08x -> 0xB7 (SIE mode)\n"), addr);
 			return 0xB7;
 		default:
-			if (log) log->Fprintf("RD 0x%08x -> 0xFF (SIE mode)\n", addr);
-			if (log) log->Fflush();
+			OUT_TRACE_LOG(TRACE_FLASH, _T("RD 0x%08x -> 0xFF (SIE mode)\n"), addr);
 			return 0xff;
 		}
 	}
 	else {
-		if (log) log->Fprintf("RD 0x%08x -> 0x%02x\n", addr, byte);
+		OUT_TRACE_LOG(TRACE_FLASH, _T("RD 0x%08x -> 0x%02x\n"), addr, byte);
 	}
 	return byte;
 }
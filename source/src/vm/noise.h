@@ -48,6 +48,10 @@ public:
 	void reset();
 	void event_callback(int event_id, int err);
 	void mix(int32_t* buffer, int cnt);
+	bool is_sound_silent()
+	{
+		return (register_id == -1 || mute);
+	}
 	void set_volume(int ch, int decibel_l, int decibel_r);
 	bool process_state(FILEIO* state_fio, bool loading);
 	
@@ -17,6 +17,8 @@ void PCM1BIT::initialize()
 	realtime = false;
 	changed = 0;
 	last_vol_l = last_vol_r = 0;
+	edge_count = 0;
+	blep_level = 0;
 	
 	register_frame_event(this);
 }
@@ -25,6 +27,7 @@ void PCM1BIT::reset()
 {
 	prev_clock = get_current_clock();
 	positive_clocks = negative_clocks = 0;
+	edge_count = 0;
 }
 
 void PCM1BIT::write_signal(int id, uint32_t data, uint32_t mask)
@@ -32,12 +35,25 @@ void PCM1BIT::write_signal(int id, uint32_t data, uint32_t mask)
 	if(id == SIG_PCM1BIT_SIGNAL) {
 		bool next = inverted ? ((data & mask) == 0) : ((data & mask) != 0);
 		if(signal != next) {
-			if(signal) {
-				positive_clocks += get_passed_clock(prev_clock);
+			if(band_limited) {
+				// keep the clock of edge to render it at the exact time
+				if(edge_count == PCM1BIT_MAX_EDGES) {
+					touch_sound();
+				}
+				if(edge_count < PCM1BIT_MAX_EDGES) {
+					edge_clocks[edge_count++] = get_current_clock();
+				} else {
+					// drop the previous edge too not to invert the level
+					edge_count--;
+				}
 			} else {
-				negative_clocks += get_passed_clock(prev_clock);
+				if(signal) {
+					positive_clocks += get_passed_clock(prev_clock);
+				} else {
+					negative_clocks += get_passed_clock(prev_clock);
+				}
+				prev_clock = get_current_clock();
 			}
-			prev_clock = get_current_clock();
 			// mute if signal is not changed in 2 frames
 			changed = 2;
 			update_realtime_render();
@@ -63,7 +79,8 @@ void PCM1BIT::event_frame()
 
 void PCM1BIT::update_realtime_render()
 {
-	bool value = (on && !mute && changed != 0);
+	// the band-limited mode does not need to mix every sample
+	bool value = (on && !mute && changed != 0 && !band_limited);
 	
 	if(realtime != value) {
 		set_realtime_render(this, value);
@@ -74,6 +91,10 @@ void PCM1BIT::update_realtime_render()
 void PCM1BIT::mix(int32_t* buffer, int cnt)
 {
 	if(on && !mute && changed) {
+		if(band_limited) {
+			mix_band_limited(buffer, cnt);
+			return;
+		}
 		if(signal) {
 			positive_clocks += get_passed_clock(prev_clock);
 		} else {
@@ -106,11 +127,76 @@ void PCM1BIT::mix(int32_t* buffer, int cnt)
 				last_vol_r++;
 			}
 		}
+		edge_count = 0;
+		if(blep_level) {
+			clear_band_limited();
+		}
 	}
 	prev_clock = get_current_clock();
 	positive_clocks = negative_clocks = 0;
 }
 
+void PCM1BIT::mix_band_limited(int32_t* buffer, int cnt)
+{
+	// the edges are inserted as the band-limited steps, at the time scaled
+	// from the clocks passed since the previous mix() to the samples
+	uint32_t clocks = get_passed_clock(prev_clock);
+	int32_t level = (signal ^ (edge_count & 1)) ? max_vol : -max_vol;
+	int32_t samples[BLEP_BLOCK];
+	int edge = 0;
+	
+	if(blep_level != level) {
+		blep.add_step(0, 0, level - blep_level);
+	}
+	for(int start = 0; start < cnt; start += BLEP_BLOCK) {
+		int block = min(cnt - start, BLEP_BLOCK);
+		for(; edge < edge_count; edge++) {
+			uint64_t pos = clocks ? (uint64_t)(edge_clocks[edge] - prev_clock) * cnt * BLEP_PHASES / clocks : 0;
+			if(pos >= (uint64_t)cnt * BLEP_PHASES) {
+				pos = cnt * BLEP_PHASES - 1;
+			}
+			int sample = (int)(pos / BLEP_PHASES) - start;
+			if(sample >= block) {
+				break;
+			}
+			level = -level;
+			blep.add_step(sample, (int)(pos % BLEP_PHASES), 2 * level);
+		}
+		blep.read_samples(samples, block);
+		for(int i = 0; i < block; i++) {
+			last_vol_l = apply_volume(samples[i], volume_l);
+			last_vol_r = apply_volume(samples[i], volume_r);
+			*buffer++ += last_vol_l; // L
+			*buffer++ += last_vol_r; // R
+		}
+	}
+	blep_level = level;
+	edge_count = 0;
+	prev_clock = get_current_clock();
+}
+
+void PCM1BIT::clear_band_limited()
+{
+	edge_count = 0;
+	blep_level = 0;
+	blep.clear();
+}
+
+bool PCM1BIT::is_sound_silent()
+{
+	if(!(on && !mute && changed) && !last_vol_l && !last_vol_r) {
+		// mix() of the silence only restarts the period to count the signal
+		prev_clock = get_current_clock();
+		positive_clocks = negative_clocks = 0;
+		edge_count = 0;
+		if(blep_level) {
+			clear_band_limited();
+		}
+		return true;
+	}
+	return false;
+}
+
 void PCM1BIT::set_volume(int ch, int decibel_l, int decibel_r)
 {
 	volume_l = decibel_to_volume(decibel_l);
@@ -122,7 +208,19 @@ void PCM1BIT::initialize_sound(int rate, int volume)
 	max_vol = volume;
 }
 
-#define STATE_VERSION	3
+void PCM1BIT::set_band_limited(bool value)
+{
+	if(band_limited != value) {
+		touch_sound();
+		band_limited = value;
+		prev_clock = get_current_clock();
+		positive_clocks = negative_clocks = 0;
+		clear_band_limited();
+		update_realtime_render();
+	}
+}
+
+#define STATE_VERSION	4
 
 bool PCM1BIT::process_state(FILEIO* state_fio, bool loading)
 {
@@ -140,6 +238,14 @@ bool PCM1BIT::process_state(FILEIO* state_fio, bool loading)
 	state_fio->StateValue(prev_clock);
 	state_fio->StateValue(positive_clocks);
 	state_fio->StateValue(negative_clocks);
+	state_fio->StateValue(band_limited);
+	state_fio->StateValue(edge_count);
+	if(edge_count < 0 || edge_count > PCM1BIT_MAX_EDGES) {
+		return false;
+	}
+	state_fio->StateArray(edge_clocks, sizeof(uint32_t) * edge_count, 1);
+	state_fio->StateValue(blep_level);
+	blep.process_state(state_fio);
 	
 	// post process
 	if(loading) {
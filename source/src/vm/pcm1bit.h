@@ -13,11 +13,15 @@
 #include "vm.h"
 #include "../emu.h"
 #include "device.h"
+#include "blep.h"
 
 #define SIG_PCM1BIT_SIGNAL	0
 #define SIG_PCM1BIT_ON		1
 #define SIG_PCM1BIT_MUTE	2
 
+// edges kept between mix() calls in the band-limited mode
+#define PCM1BIT_MAX_EDGES	1024
+
 class PCM1BIT : public DEVICE
 {
 private:
@@ -28,12 +32,22 @@ private:
 	int max_vol, last_vol_l, last_vol_r;
 	int volume_l, volume_r;
 	
+	// band-limited synthesis
+	bool band_limited;
+	uint32_t edge_clocks[PCM1BIT_MAX_EDGES];
+	int edge_count;
+	int32_t blep_level;
+	BLEP blep;
+	
 	void update_realtime_render();
+	void mix_band_limited(int32_t* buffer, int cnt);
+	void clear_band_limited();
 	
 public:
 	PCM1BIT(VM_TEMPLATE* parent_vm, EMU* parent_emu, bool inverted = false) : DEVICE(parent_vm, parent_emu), inverted(inverted)
 	{
 		volume_l = volume_r = 1024;
+		band_limited = false;
 		set_device_name(_T("1-Bit PCM Sound"));
 	}
 	~PCM1BIT() {}
@@ -44,11 +58,13 @@ public:
 	void write_signal(int id, uint32_t data, uint32_t mask);
 	void event_frame();
 	void mix(int32_t* buffer, int cnt);
+	bool is_sound_silent();
 	void set_volume(int ch, int decibel_l, int decibel_r);
 	bool process_state(FILEIO* state_fio, bool loading);
 	
 	// unique function
 	void initialize_sound(int rate, int volume);
+	void set_band_limited(bool value);
 };
 
 #endif
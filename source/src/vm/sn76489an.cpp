@@ -26,6 +26,10 @@ void SN76489AN::initialize()
 {
 	mute = false;
 	cs = we = true;
+	
+	// reset() mixes the sound before the channels are cleared
+	memset(ch, 0, sizeof(ch));
+	noise_gen = NOISE_FB;
 }
 
 void SN76489AN::reset()
@@ -132,6 +136,10 @@ void SN76489AN::mix(int32_t* buffer, int cnt)
 	if(mute) {
 		return;
 	}
+	if(band_limited) {
+		mix_band_limited(buffer, cnt);
+		return;
+	}
 	for(int i = 0; i < cnt; i++) {
 		int32_t vol_l = 0, vol_r = 0;
 		for(int j = 0; j < 4; j++) {
@@ -167,6 +175,76 @@ void SN76489AN::mix(int32_t* buffer, int cnt)
 	}
 }
 
+void SN76489AN::mix_band_limited(int32_t* buffer, int cnt)
+{
+	// each edge of the channels is inserted as a band-limited step at the
+	// exact sub-sample time, instead of stepping the channels every sample
+	int32_t samples[BLEP_BLOCK];
+	
+	while(cnt > 0) {
+		int block = min(cnt, BLEP_BLOCK);
+		int end = block * diff;
+		
+		for(int j = 0; j < 4; j++) {
+			// the tone over nyquist is held high as the volume pcm
+			bool hold = (j < 3 && (ch[j].period << 8) < diff);
+			int32_t level = 0;
+			if(ch[j].volume) {
+				level = (hold || ch[j].signal) ? ch[j].volume : -ch[j].volume;
+			}
+			if(ch[j].level != level) {
+				blep.add_step(0, 0, level - ch[j].level);
+				ch[j].level = level;
+			}
+			if(!ch[j].volume || hold) {
+				continue;
+			}
+			int period = ch[j].period << 8;
+			int t = ch[j].count;
+			for(; t < end; t += period) {
+				if(j == 3) {
+					if(((noise_gen & NOISE_DST_TAP) ? 1 : 0) ^ (((noise_gen & NOISE_SRC_TAP) ? 1 : 0) * NOISE_MODE)) {
+						noise_gen >>= 1;
+						noise_gen |= NOISE_FB;
+					} else {
+						noise_gen >>= 1;
+					}
+					ch[3].signal = ((noise_gen & 1) != 0);
+				} else {
+					ch[j].signal = !ch[j].signal;
+				}
+				level = ch[j].signal ? ch[j].volume : -ch[j].volume;
+				if(ch[j].level != level) {
+					blep.add_step(t / diff, (t % diff) * BLEP_PHASES / diff, level - ch[j].level);
+					ch[j].level = level;
+				}
+			}
+			ch[j].count = t - end;
+		}
+		blep.read_samples(samples, block);
+		for(int i = 0; i < block; i++) {
+			*buffer++ += apply_volume(samples[i], volume_l); // L
+			*buffer++ += apply_volume(samples[i], volume_r); // R
+		}
+		cnt -= block;
+	}
+}
+
+bool SN76489AN::is_sound_silent()
+{
+	// the channels of volume 0 are not counted in mix()
+	if(mute) {
+		return true;
+	}
+	for(int i = 0; i < 4; i++) {
+		if(ch[i].volume || ch[i].level) {
+			return false;
+		}
+	}
+	// wait until the tail of the last step is out
+	return !band_limited || blep.is_idle();
+}
+
 void SN76489AN::set_volume(int ch, int decibel_l, int decibel_r)
 {
 	volume_l = decibel_to_volume(decibel_l);
@@ -185,7 +263,19 @@ void SN76489AN::initialize_sound(int rate, int clock, int volume)
 	diff = (int)(16.0 * (double)clock / (double)rate + 0.5);
 }
 
-#define STATE_VERSION	2
+void SN76489AN::set_band_limited(bool value)
+{
+	if(band_limited != value) {
+		touch_sound();
+		band_limited = value;
+		for(int i = 0; i < 4; i++) {
+			ch[i].level = 0;
+		}
+		blep.clear();
+	}
+}
+
+#define STATE_VERSION	3
 
 bool SN76489AN::process_state(FILEIO* state_fio, bool loading)
 {
@@ -197,7 +287,7 @@ bool SN76489AN::process_state(FILEIO* state_fio, bool loading)
 	}
 	state_fio->StateArray(regs, sizeof(regs), 1);
 	state_fio->StateValue(index);
-	for(int i = 0; i < array_length(ch); i++) {
+	for(int i = 0; i < (int)array_length(ch); i++) {
 		state_fio->StateValue(ch[i].count);
 		state_fio->StateValue(ch[i].period);
 		state_fio->StateValue(ch[i].volume);
@@ -208,6 +298,11 @@ bool SN76489AN::process_state(FILEIO* state_fio, bool loading)
 	state_fio->StateValue(cs);
 	state_fio->StateValue(we);
 	state_fio->StateValue(val);
+	state_fio->StateValue(band_limited);
+	for(int i = 0; i < (int)array_length(ch); i++) {
+		state_fio->StateValue(ch[i].level);
+	}
+	blep.process_state(state_fio);
 	return true;
 }
 
@@ -13,6 +13,7 @@
 #include "vm.h"
 #include "../emu.h"
 #include "device.h"
+#include "blep.h"
 
 #define SIG_SN76489AN_MUTE	0
 #define SIG_SN76489AN_DATA	1
@@ -32,6 +33,7 @@ private:
 		int period;
 		int volume;
 		bool signal;
+		int32_t level;	// band-limited output
 	} ch[4];
 	uint32_t noise_gen;
 	int volume_table[16];
@@ -40,10 +42,16 @@ private:
 	uint8_t val;
 	int volume_l, volume_r;
 	
+	// band-limited synthesis
+	bool band_limited;
+	BLEP blep;
+	void mix_band_limited(int32_t* buffer, int cnt);
+	
 public:
 	SN76489AN(VM_TEMPLATE* parent_vm, EMU* parent_emu) : DEVICE(parent_vm, parent_emu)
 	{
 		volume_l = volume_r = 1024;
+		band_limited = false;
 #ifdef HAS_SN76489
 		set_device_name(_T("SN76489 PSG"));
 #else
@@ -58,11 +66,13 @@ public:
 	void write_io8(uint32_t addr, uint32_t data);
 	void write_signal(int id, uint32_t data, uint32_t mask);
 	void mix(int32_t* buffer, int cnt);
+	bool is_sound_silent();
 	void set_volume(int ch, int decibel_l, int decibel_r);
 	bool process_state(FILEIO* state_fio, bool loading);
 	
 	// unique function
 	void initialize_sound(int rate, int clock, int volume);
+	void set_band_limited(bool value);
 };
 
 #endif
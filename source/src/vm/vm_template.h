@@ -15,6 +15,7 @@
 class EMU;
 class EVENT;
 class DEVICE;
+class SOUND_WRITER;
 
 class DLL_PREFIX VM_TEMPLATE {
 protected:
@@ -52,6 +53,7 @@ public:
 	
 	// draw screen
 	virtual void draw_screen() { }
+	virtual void set_render_demand(bool value) { }
 	
 	// multimedia
 	virtual void movie_sound_callback(uint8_t *buffer, long size) { }
@@ -61,6 +63,8 @@ public:
 	virtual uint16_t* create_sound(int* extra_frames) { return NULL; }
 	virtual int get_sound_buffer_ptr() { return 0; }
 	virtual void set_sound_device_volume(int ch, int decibel_l, int decibel_r) { }
+	virtual bool start_record_sound_stems(SOUND_WRITER* writer, const _TCHAR* prefix) { return false; }
+	virtual void stop_record_sound_stems() { }
 	
 	// network
 	virtual void notify_socket_connected(int ch) { }
@@ -151,6 +155,9 @@ public:
 	virtual void set_vm_frame_rate(double fps) { }
 	virtual double get_vm_frame_rate() { return 59.94; }
 	virtual bool is_frame_skippable() { return false; }
+	virtual uint64_t get_total_cpu_clocks() { return 0; }
+	virtual uint64_t get_total_fired_events() { return 0; }
+	virtual uint64_t get_total_redrawn_rows() { return 0; }
 	virtual bool is_screen_changed() { return true; }
 	virtual int max_draw_ranges() { return 0; }
 	virtual DEVICE* get_device(int id) { return first_device; }
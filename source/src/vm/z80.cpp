@@ -1545,6 +1545,37 @@ static const uint8_t cc_ex[0x100] = {
 	} \
 } while(0)
 
+#ifdef Z80_BATCH_EXTRA_EVENT
+#ifdef Z80_BLOCK_CACHE
+#define PASS_EXTRA_EVENT() do { \
+	update_extra_event(extra_event_clocks); \
+	extra_event_passed += extra_event_clocks; \
+	extra_event_clocks = 0; \
+} while(0)
+#else
+#define PASS_EXTRA_EVENT() do { \
+	update_extra_event(extra_event_clocks); \
+	extra_event_clocks = 0; \
+} while(0)
+#endif
+
+#define UPDATE_EXTRA_EVENT(clock) do { \
+	if(is_primary) { \
+		if(busreq) { \
+			busreq_icount += (clock); \
+		} \
+		if((extra_event_clocks += (clock)) >= *extra_event_limit) { \
+			PASS_EXTRA_EVENT(); \
+		} \
+	} \
+} while(0)
+
+#define FLUSH_EXTRA_EVENT() do { \
+	if(extra_event_clocks != 0) { \
+		PASS_EXTRA_EVENT(); \
+	} \
+} while(0)
+#else
 #define UPDATE_EXTRA_EVENT(clock) do { \
 	if(is_primary) { \
 		if(busreq) { \
@@ -1554,9 +1585,65 @@ static const uint8_t cc_ex[0x100] = {
 	} \
 } while(0)
 
+#define FLUSH_EXTRA_EVENT()
+#endif
+
+#ifdef Z80_MEMORY_PAGE_TABLE
+#define IS_FAST_PAGE(addr) (!((*mem_slow_pages >> (((addr) >> 11) & 0x1f)) & 1))
+#endif
+
+#ifdef Z80_BLOCK_CACHE
+#define CHECK_BLOCK_CODE(addr) do { \
+	if(block_code_map[((addr) >> 3) & 0x1fff] & (1 << ((addr) & 7))) { \
+		invalidate_block_page(((addr) >> 11) & 0x1f); \
+	} \
+} while(0)
+#ifdef Z80_BLOCK_CACHE_CHECK
+#define BLOCK_BUS_FETCH	0
+#define BLOCK_BUS_READ	1
+#define BLOCK_BUS_WRITE	2
+#define BLOCK_BUS_IN	3
+#define BLOCK_BUS_OUT	4
+#define LOG_BLOCK_BUS(type, addr, data) do { \
+	if(block_bus_logging) { \
+		log_block_bus(type, addr, data); \
+	} \
+} while(0)
+#endif
+#else
+#define CHECK_BLOCK_CODE(addr)
+#endif
+#ifndef LOG_BLOCK_BUS
+#define LOG_BLOCK_BUS(type, addr, data)
+#endif
+
+#ifdef Z80_MEMORY_HEATMAP
+inline void Z80::add_heat(int type, uint32_t addr, uint8_t data)
+{
+	heat_count[type][addr & 0xffff]++;
+	if(watch_map[(addr >> 3) & 0x1fff] & (1 << (addr & 7))) {
+		hit_watch(type, addr, data);
+	}
+}
+#define ADD_HEAT(type, addr, data) add_heat(type, addr, data)
+#else
+#define ADD_HEAT(type, addr, data)
+#endif
+
 inline uint8_t Z80::RM8(uint32_t addr)
 {
 	UPDATE_EXTRA_EVENT(1);
+#ifdef Z80_MEMORY_PAGE_TABLE
+	if(IS_FAST_PAGE(addr)) {
+		uint8_t val = mem_rbank[(addr >> 11) & 0x1f][addr & 0x7ff];
+		ADD_HEAT(HEAT_READ, addr, val);
+		LOG_BLOCK_BUS(BLOCK_BUS_READ, addr, val);
+		UPDATE_EXTRA_EVENT(2);
+		++mc_index;
+		return val;
+	}
+#endif
+	FLUSH_EXTRA_EVENT();
 #ifdef Z80_MEMORY_WAIT
 	int wait;
 	uint8_t val = d_mem->read_data8w(addr, &wait);
@@ -1566,6 +1653,8 @@ inline uint8_t Z80::RM8(uint32_t addr)
 	uint8_t val = d_mem->read_data8(addr);
 	UPDATE_EXTRA_EVENT(2);
 #endif
+	ADD_HEAT(HEAT_READ, addr, val);
+	LOG_BLOCK_BUS(BLOCK_BUS_READ, addr, val);
 	++mc_index;
 	return val;
 }
@@ -1573,6 +1662,18 @@ inline uint8_t Z80::RM8(uint32_t addr)
 inline void Z80::WM8(uint32_t addr, uint8_t val)
 {
 	UPDATE_EXTRA_EVENT(1);
+	CHECK_BLOCK_CODE(addr);
+	ADD_HEAT(HEAT_WRITE, addr, val);
+	LOG_BLOCK_BUS(BLOCK_BUS_WRITE, addr, val);
+#ifdef Z80_MEMORY_PAGE_TABLE
+	if(IS_FAST_PAGE(addr)) {
+		mem_wbank[(addr >> 11) & 0x1f][addr & 0x7ff] = val;
+		UPDATE_EXTRA_EVENT(2);
+		++mc_index;
+		return;
+	}
+#endif
+	FLUSH_EXTRA_EVENT();
 #ifdef Z80_MEMORY_WAIT
 	int wait;
 	d_mem->write_data8w(addr, val, &wait);
@@ -1607,10 +1708,23 @@ inline uint8_t Z80::FETCHOP()
 
 	// consider m1 cycle wait
 	UPDATE_EXTRA_EVENT(1);
+#ifdef Z80_MEMORY_PAGE_TABLE
+	if(IS_FAST_PAGE(pctmp)) {
+		uint8_t val = mem_rbank[(pctmp >> 11) & 0x1f][pctmp & 0x7ff];
+		ADD_HEAT(HEAT_EXEC, pctmp, val);
+		LOG_BLOCK_BUS(BLOCK_BUS_FETCH, pctmp, val);
+		UPDATE_EXTRA_EVENT(3);
+		++mc_index;
+		return val;
+	}
+#endif
+	FLUSH_EXTRA_EVENT();
 	int wait;
 	uint8_t val = d_mem->fetch_op(pctmp, &wait);
 	icount -= wait;
 	UPDATE_EXTRA_EVENT(3 + wait);
+	ADD_HEAT(HEAT_EXEC, pctmp, val);
+	LOG_BLOCK_BUS(BLOCK_BUS_FETCH, pctmp, val);
 	++mc_index;
 	return val;
 }
@@ -1632,15 +1746,18 @@ inline uint32_t Z80::FETCH16()
 inline uint8_t Z80::IN8(uint32_t addr)
 {
 	UPDATE_EXTRA_EVENT(2);
+	FLUSH_EXTRA_EVENT();
 #ifdef Z80_IO_WAIT
 	int wait;
 	uint8_t val = d_io->read_io8w(addr, &wait);
 	icount -= wait;
 	UPDATE_EXTRA_EVENT(2 + wait);
+	LOG_BLOCK_BUS(BLOCK_BUS_IN, addr, val);
 	return val;
 #else
 	uint8_t val = d_io->read_io8(addr);
 	UPDATE_EXTRA_EVENT(2);
+	LOG_BLOCK_BUS(BLOCK_BUS_IN, addr, val);
 	return val;
 #endif
 }
@@ -1648,6 +1765,7 @@ inline uint8_t Z80::IN8(uint32_t addr)
 inline void Z80::OUT8(uint32_t addr, uint8_t val)
 {
 	UPDATE_EXTRA_EVENT(2);
+	LOG_BLOCK_BUS(BLOCK_BUS_OUT, addr, val);
 #ifdef HAS_NSC800
 	if((addr & 0xff) == 0xbb) {
 		icr = val;
@@ -1655,6 +1773,7 @@ inline void Z80::OUT8(uint32_t addr, uint8_t val)
 		return;
 	}
 #endif
+	FLUSH_EXTRA_EVENT();
 #ifdef Z80_IO_WAIT
 	int wait;
 	d_io->write_io8w(addr, val, &wait);
@@ -1713,11 +1832,20 @@ inline void Z80::OUT8(uint32_t addr, uint8_t val)
 	} else FETCH8(); \
 } while(0)
 
+#ifdef Z80_PROFILER
+#define PROFILE_CALL() profile_call()
+#define PROFILE_RET() profile_ret()
+#else
+#define PROFILE_CALL()
+#define PROFILE_RET()
+#endif
+
 #define CALL() do { \
 	ea = FETCH16(); \
 	WZ = ea; \
 	PUSH(pc); \
 	PCD = ea; \
+	PROFILE_CALL(); \
 } while(0)
 
 #define CALL_COND(cond, opcode) do { \
@@ -1726,6 +1854,7 @@ inline void Z80::OUT8(uint32_t addr, uint8_t val)
 		WZ = ea; \
 		PUSH(pc); \
 		PCD = ea; \
+		PROFILE_CALL(); \
 		icount -= cc_ex[opcode]; \
 	} else { \
 		WZ = FETCH16(); /* implicit call PC+=2; */ \
@@ -1735,6 +1864,7 @@ inline void Z80::OUT8(uint32_t addr, uint8_t val)
 #define RET_COND(cond, opcode) do { \
 	if(cond) { \
 		POP(pc); \
+		PROFILE_RET(); \
 		WZ = PC; \
 		icount -= cc_ex[opcode]; \
 	} \
@@ -1742,14 +1872,17 @@ inline void Z80::OUT8(uint32_t addr, uint8_t val)
 
 #define RETN() do { \
 	POP(pc); \
+	PROFILE_RET(); \
 	WZ = PC; \
 	iff1 = iff2; \
 } while(0)
 
 #define RETI() do { \
 	POP(pc); \
+	PROFILE_RET(); \
 	WZ = PC; \
 	iff1 = iff2; \
+	FLUSH_EXTRA_EVENT(); \
 	d_pic->notify_intr_reti(); \
 } while(0)
 
@@ -1778,6 +1911,7 @@ inline void Z80::OUT8(uint32_t addr, uint8_t val)
 	PUSH(pc); \
 	PCD = addr; \
 	WZ = PC; \
+	PROFILE_CALL(); \
 } while(0)
 
 inline uint8_t Z80::INC(uint8_t value)
@@ -3247,9 +3381,9 @@ void Z80::OP(uint8_t code)
 		if(d_bios != NULL) {
 			d_bios->bios_ret_z80(prevpc, &af, &bc, &de, &hl, &ix, &iy, &iff1);
 		}
-		POP(pc); WZ = PCD; break;										/* RET              */
+		POP(pc); PROFILE_RET(); WZ = PCD; break;								/* RET              */
 #else
-	case 0xc9: POP(pc); WZ = PCD; break;										/* RET              */
+	case 0xc9: POP(pc); PROFILE_RET(); WZ = PCD; break;								/* RET              */
 #endif
 	case 0xca: JP_COND(F & ZF); break;										/* JP   Z,a         */
 	case 0xcb: OP_CB(FETCHOP()); break;										/* **** CB xx       */
@@ -3385,15 +3519,81 @@ void Z80::initialize()
 		flags_initialized = true;
 	}
 	is_primary = is_primary_cpu(this);
+#ifdef Z80_BATCH_EXTRA_EVENT
+	if(is_primary) {
+		extra_event_limit = get_extra_event_limit_ptr();
+	}
+#endif
+#ifdef Z80_BLOCK_CACHE
+	blocks = new block_t[Z80_BLOCK_CACHE_SIZE];
+	for(int i = 0; i < Z80_BLOCK_CACHE_SIZE; i++) {
+		blocks[i].pc = 0xffffffff;
+	}
+	memset(block_gen, 0, sizeof(block_gen));
+	memset(block_code_map, 0, sizeof(block_code_map));
+#ifdef Z80_BLOCK_CACHE_CHECK
+	block_bus_count = 0;
+	block_bus_logging = false;
+#endif
+	block_reg8[0] = &B;
+	block_reg8[1] = &C;
+	block_reg8[2] = &D;
+	block_reg8[3] = &E;
+	block_reg8[4] = &H;
+	block_reg8[5] = &L;
+	block_reg8[6] = NULL;	// (HL) is not pre-decoded
+	block_reg8[7] = &A;
+	block_reg16[0] = &bc;
+	block_reg16[1] = &de;
+	block_reg16[2] = &hl;
+	block_reg16[3] = &sp;
+#endif
 	
 #ifdef USE_DEBUGGER
 	d_mem_stored = d_mem;
 	d_io_stored = d_io;
+#ifdef Z80_MEMORY_PAGE_TABLE
+	mem_slow_pages_stored = mem_slow_pages;
+#endif
 	d_debugger->set_context_mem(d_mem);
 	d_debugger->set_context_io(d_io);
 #endif
+#ifdef Z80_EXEC_TRACE
+	exec_trace = new z80_exec_trace_t[Z80_EXEC_TRACE_SIZE];
+	exec_trace_ptr = 0;
+#endif
+#ifdef Z80_PROFILER
+	prof_nodes = new z80_profile_node_t[Z80_PROFILER_MAX_NODES];
+	prof_clocks = new uint64_t[0x10000];
+	clear_debug_profile();
+#endif
+#ifdef Z80_MEMORY_HEATMAP
+	heat_count[0] = new uint32_t[0x10000 * 3];
+	heat_count[1] = heat_count[0] + 0x10000;
+	heat_count[2] = heat_count[1] + 0x10000;
+	clear_debug_heatmap();
+#endif
 }
 
+#if defined(Z80_BLOCK_CACHE) || defined(Z80_EXEC_TRACE) || defined(Z80_PROFILER) || defined(Z80_MEMORY_HEATMAP)
+void Z80::release()
+{
+#ifdef Z80_BLOCK_CACHE
+	delete[] blocks;
+#endif
+#ifdef Z80_EXEC_TRACE
+	delete[] exec_trace;
+#endif
+#ifdef Z80_PROFILER
+	delete[] prof_nodes;
+	delete[] prof_clocks;
+#endif
+#ifdef Z80_MEMORY_HEATMAP
+	delete[] heat_count[0];
+#endif
+}
+#endif
+
 void Z80::reset()
 {
 	PCD = CPU_START_ADDR;
@@ -3412,6 +3612,12 @@ void Z80::reset()
 	intr_req_bit = intr_pend_bit = 0;
 	
 	icount = extra_icount = busreq_icount = 0;
+#ifdef Z80_BLOCK_CACHE
+	invalidate_block_cache();
+#endif
+#ifdef Z80_PROFILER
+	prof_node = prof_op_node = prof_depth = 0;
+#endif
 }
 
 void Z80::write_signal(int id, uint32_t data, uint32_t mask)
@@ -3434,6 +3640,10 @@ void Z80::write_signal(int id, uint32_t data, uint32_t mask)
 		intr_req_bit = (data & mask) ? (intr_req_bit | 4) : (intr_req_bit & ~4);
 	} else if(id == SIG_NSC800_RSTC) {
 		intr_req_bit = (data & mask) ? (intr_req_bit | 2) : (intr_req_bit & ~2);
+#endif
+#ifdef Z80_BLOCK_CACHE
+	} else if(id == SIG_Z80_BLOCK_CACHE_FLUSH) {
+		invalidate_block_cache();
 #endif
 	}
 }
@@ -3446,6 +3656,94 @@ uint32_t Z80::read_signal(int id)
 	return 0;
 }
 
+#ifdef Z80_EXEC_TRACE
+inline void Z80::add_exec_trace()
+{
+	// the ring buffer is written only by the cpu thread, so no lock is needed
+	z80_exec_trace_t *trace = &exec_trace[exec_trace_ptr++ & (Z80_EXEC_TRACE_SIZE - 1)];
+	trace->clock = total_icount;
+	trace->pc = PC;
+	trace->af = AF;
+	trace->bc = BC;
+	trace->de = DE;
+	trace->hl = HL;
+	trace->ix = IX;
+	trace->iy = IY;
+	trace->sp = SP;
+	for(int i = 0; i < 4; i++) {
+		uint32_t addr = (PCD + i) & 0xffff;
+#ifdef Z80_MEMORY_PAGE_TABLE
+		// don't access the memory device not to change its status
+		trace->ops[i] = mem_rbank[addr >> 11][addr & 0x7ff];
+#else
+		int wait;
+		trace->ops[i] = d_mem_stored->read_data8w(addr, &wait);
+#endif
+	}
+#ifdef Z80_EXEC_TRACE_TRIGGER
+	if(Z80_EXEC_TRACE_TRIGGER) {
+		save_debug_trace(create_date_file_path(_T("z80trace")));
+	}
+#endif
+}
+#endif
+
+#ifdef Z80_PROFILER
+inline void Z80::start_profile()
+{
+	prof_pc = PC;
+	prof_op_node = prof_node;
+}
+
+inline void Z80::add_profile(int clock)
+{
+	prof_clocks[prof_pc] += clock;
+	prof_nodes[prof_op_node].clocks += clock;
+}
+
+void Z80::profile_call()
+{
+	// find the node of the called function in the children of the current node
+	int node;
+	for(node = prof_nodes[prof_node].child; node != -1; node = prof_nodes[node].sibling) {
+		if(prof_nodes[node].addr == PC) {
+			break;
+		}
+	}
+	if(node == -1) {
+		if(prof_node_count < Z80_PROFILER_MAX_NODES) {
+			node = prof_node_count++;
+			memset(&prof_nodes[node], 0, sizeof(z80_profile_node_t));
+			prof_nodes[node].addr = PC;
+			prof_nodes[node].parent = prof_node;
+			prof_nodes[node].child = -1;
+			prof_nodes[node].sibling = prof_nodes[prof_node].child;
+			prof_nodes[prof_node].child = node;
+		} else {
+			// no more node, the clocks are counted in the caller
+			node = prof_node;
+		}
+	}
+	prof_nodes[node].calls++;
+	
+	if(prof_depth < Z80_PROFILER_MAX_DEPTH) {
+		prof_stack[prof_depth].node = prof_node;
+		prof_stack[prof_depth].sp = SP;
+		prof_depth++;
+		prof_node = node;
+	}
+}
+
+void Z80::profile_ret()
+{
+	// return to the caller that pushed the address below SP,
+	// the frames are discarded when the stack is unwound without RET
+	while(prof_depth > 0 && (int16_t)(SP - prof_stack[prof_depth - 1].sp) > 0) {
+		prof_node = prof_stack[--prof_depth].node;
+	}
+}
+#endif
+
 int Z80::run(int clock)
 {
 	if(clock == -1) {
@@ -3477,7 +3775,18 @@ int Z80::run(int clock)
 			}
 			icount = -extra_icount;
 			extra_icount = busreq_icount = 0;
+#ifdef Z80_BATCH_EXTRA_EVENT
+			// clocks not passed to update_extra_event are consumed by the event manager with the returned clocks
+			extra_event_clocks = 0;
+#endif
+#ifdef Z80_BLOCK_CACHE
+			extra_event_passed = -icount;
+			if(!run_block()) {
+				run_one_opecode();
+			}
+#else
 			run_one_opecode();
+#endif
 			return -icount;
 		}
 	} else {
@@ -3519,6 +3828,7 @@ void Z80::run_one_opecode()
 #ifdef USE_DEBUGGER
 	bool now_debugging = d_debugger->now_debugging;
 	if(now_debugging) {
+		FLUSH_EXTRA_EVENT();
 		d_debugger->check_break_points(PC);
 		if(d_debugger->now_suspended) {
 			d_debugger->now_waiting = true;
@@ -3531,6 +3841,9 @@ void Z80::run_one_opecode()
 		}
 		if(d_debugger->now_debugging) {
 			d_mem = d_io = d_debugger;
+#ifdef Z80_MEMORY_PAGE_TABLE
+			mem_slow_pages = &mem_all_slow_pages;
+#endif
 		} else {
 			now_debugging = false;
 		}
@@ -3540,11 +3853,20 @@ void Z80::run_one_opecode()
 		after_ldair = false;
 #endif
 		d_debugger->add_cpu_trace(PC);
+#ifdef Z80_EXEC_TRACE
+		add_exec_trace();
+#endif
+#ifdef Z80_PROFILER
+		start_profile();
+#endif
 		first_icount = icount;
 		OP(FETCHOP());
 		icount -= extra_icount;
 		extra_icount = 0;
 		total_icount += first_icount - icount;
+#ifdef Z80_PROFILER
+		add_profile(first_icount - icount);
+#endif
 #if HAS_LDAIR_QUIRK
 		if(after_ldair) {
 			F &= ~PF;	// reset parity flag after LD A,I or LD A,R
@@ -3552,6 +3874,7 @@ void Z80::run_one_opecode()
 #endif
 #ifdef SINGLE_MODE_DMA
 		if(d_dma) {
+			FLUSH_EXTRA_EVENT();
 			d_dma->do_dma();
 		}
 #endif
@@ -3565,6 +3888,9 @@ void Z80::run_one_opecode()
 			}
 			d_mem = d_mem_stored;
 			d_io = d_io_stored;
+#ifdef Z80_MEMORY_PAGE_TABLE
+			mem_slow_pages = mem_slow_pages_stored;
+#endif
 		}
 	} else {
 #endif
@@ -3574,6 +3900,12 @@ void Z80::run_one_opecode()
 #endif
 #ifdef USE_DEBUGGER
 		d_debugger->add_cpu_trace(PC);
+#endif
+#ifdef Z80_EXEC_TRACE
+		add_exec_trace();
+#endif
+#ifdef Z80_PROFILER
+		start_profile();
 #endif
 		first_icount = icount;
 		OP(FETCHOP());
@@ -3582,6 +3914,9 @@ void Z80::run_one_opecode()
 		extra_icount = 0;
 		total_icount += first_icount - icount;
 #endif
+#ifdef Z80_PROFILER
+		add_profile(first_icount - icount);
+#endif
 #if HAS_LDAIR_QUIRK
 		if(after_ldair) {
 			F &= ~PF;	// reset parity flag after LD A,I or LD A,R
@@ -3589,6 +3924,7 @@ void Z80::run_one_opecode()
 #endif
 #ifdef SINGLE_MODE_DMA
 		if(d_dma) {
+			FLUSH_EXTRA_EVENT();
 			d_dma->do_dma();
 		}
 #endif
@@ -3616,6 +3952,9 @@ void Z80::run_one_opecode()
 			}
 			if(d_debugger->now_debugging) {
 				d_mem = d_io = d_debugger;
+#ifdef Z80_MEMORY_PAGE_TABLE
+				mem_slow_pages = &mem_all_slow_pages;
+#endif
 			} else {
 				now_debugging = false;
 			}
@@ -3625,11 +3964,20 @@ void Z80::run_one_opecode()
 			after_ldair = false;
 #endif
 			d_debugger->add_cpu_trace(PC);
+#ifdef Z80_EXEC_TRACE
+			add_exec_trace();
+#endif
+#ifdef Z80_PROFILER
+			start_profile();
+#endif
 			first_icount = icount;
 			OP(FETCHOP());
 			icount -= extra_icount;
 			extra_icount = 0;
 			total_icount += first_icount - icount;
+#ifdef Z80_PROFILER
+			add_profile(first_icount - icount);
+#endif
 #if HAS_LDAIR_QUIRK
 			if(after_ldair) {
 				F &= ~PF;	// reset parity flag after LD A,I or LD A,R
@@ -3637,9 +3985,11 @@ void Z80::run_one_opecode()
 #endif
 #ifdef SINGLE_MODE_DMA
 			if(d_dma) {
+				FLUSH_EXTRA_EVENT();
 				d_dma->do_dma();
 			}
 #endif
+			FLUSH_EXTRA_EVENT();
 			d_pic->notify_intr_ei();
 			check_interrupt();
 			
@@ -3649,6 +3999,9 @@ void Z80::run_one_opecode()
 				}
 				d_mem = d_mem_stored;
 				d_io = d_io_stored;
+#ifdef Z80_MEMORY_PAGE_TABLE
+				mem_slow_pages = mem_slow_pages_stored;
+#endif
 			}
 		} else {
 #endif
@@ -3658,6 +4011,12 @@ void Z80::run_one_opecode()
 #endif
 #ifdef USE_DEBUGGER
 			d_debugger->add_cpu_trace(PC);
+#endif
+#ifdef Z80_EXEC_TRACE
+			add_exec_trace();
+#endif
+#ifdef Z80_PROFILER
+			start_profile();
 #endif
 			first_icount = icount;
 			OP(FETCHOP());
@@ -3666,6 +4025,9 @@ void Z80::run_one_opecode()
 			extra_icount = 0;
 			total_icount += first_icount - icount;
 #endif
+#ifdef Z80_PROFILER
+			add_profile(first_icount - icount);
+#endif
 #if HAS_LDAIR_QUIRK
 			if(after_ldair) {
 				F &= ~PF;	// reset parity flag after LD A,I or LD A,R
@@ -3673,9 +4035,11 @@ void Z80::run_one_opecode()
 #endif
 #ifdef SINGLE_MODE_DMA
 			if(d_dma) {
+				FLUSH_EXTRA_EVENT();
 				d_dma->do_dma();
 			}
 #endif
+			FLUSH_EXTRA_EVENT();
 			d_pic->notify_intr_ei();
 			check_interrupt();
 #ifdef USE_DEBUGGER
@@ -3692,6 +4056,9 @@ void Z80::check_interrupt()
 {
 #ifdef USE_DEBUGGER
 	int first_icount = icount;
+#endif
+#ifdef Z80_PROFILER
+	uint16_t first_sp = SP;
 #endif
 	// check interrupt
 	if(intr_req_bit) {
@@ -3708,6 +4075,7 @@ void Z80::check_interrupt()
 			// INTR
 			LEAVE_HALT();
 			PUSH(pc);
+			FLUSH_EXTRA_EVENT();
 			PCD = WZ = d_pic->get_intr_ack() & 0xffff;
 			icount -= cc_op[0xcd] + cc_ex[0xff];
 			iff1 = iff2 = 0;
@@ -3741,6 +4109,7 @@ void Z80::check_interrupt()
 			// interrupt
 			LEAVE_HALT();
 			
+			FLUSH_EXTRA_EVENT();
 			uint32_t vector = d_pic->get_intr_ack();
 			if(im == 0) {
 				// mode 0 (support NOP/JMP/CALL/RST only)
@@ -3780,13 +4149,590 @@ void Z80::check_interrupt()
 #ifdef USE_DEBUGGER
 	total_icount += first_icount - icount;
 #endif
+#ifdef Z80_PROFILER
+	if(SP != first_sp) {
+		// interrupt is accepted and the handler is called
+		profile_call();
+		start_profile();
+		add_profile(first_icount - icount);
+	}
+#endif
+}
+
+#ifdef Z80_BLOCK_CACHE
+// pre-decoded block cache
+
+#define BLOCK_OP_GENERIC	0
+#define BLOCK_OP_NOP		1
+#define BLOCK_OP_LD_R_R		2
+#define BLOCK_OP_LD_R_N		3
+#define BLOCK_OP_INC_R		4
+#define BLOCK_OP_DEC_R		5
+#define BLOCK_OP_LD_RR_NN	6
+#define BLOCK_OP_INC_RR		7
+#define BLOCK_OP_DEC_RR		8
+#define BLOCK_OP_EX_DE_HL	9
+#define BLOCK_OP_ALU_R		10	// 10-17: ADD/ADC/SUB/SBC/AND/XOR/OR/CP A,r
+#define BLOCK_OP_ALU_N		18	// 18-25: ADD/ADC/SUB/SBC/AND/XOR/OR/CP A,n
+
+// bit0-2: length of opecode, bit6: block is ended by this opecode, bit7: opecode is not pre-decoded
+#define BLOCK_END	0x40
+#define BLOCK_STOP	0x80
+
+static const uint8_t block_op_info[0x100] = {
+	0x01, 0x03, 0x01, 0x01, 0x01, 0x01, 0x02, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x02, 0x01,
+	0x42, 0x03, 0x01, 0x01, 0x01, 0x01, 0x02, 0x01, 0x42, 0x01, 0x01, 0x01, 0x01, 0x01, 0x02, 0x01,
+	0x42, 0x03, 0x03, 0x01, 0x01, 0x01, 0x02, 0x01, 0x42, 0x01, 0x03, 0x01, 0x01, 0x01, 0x02, 0x01,
+	0x42, 0x03, 0x03, 0x01, 0x01, 0x01, 0x02, 0x01, 0x42, 0x01, 0x03, 0x01, 0x01, 0x01, 0x02, 0x01,
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x41, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+	0x41, 0x01, 0x43, 0x43, 0x43, 0x01, 0x02, 0x41, 0x41, 0x41, 0x43, 0x02, 0x43, 0x43, 0x02, 0x41,
+	0x41, 0x01, 0x43, 0x02, 0x43, 0x01, 0x02, 0x41, 0x41, 0x01, 0x43, 0x02, 0x43, 0x42, 0x02, 0x41,
+	0x41, 0x01, 0x43, 0x01, 0x43, 0x01, 0x02, 0x41, 0x41, 0x41, 0x43, 0x01, 0x43, 0x02, 0x02, 0x41,
+	0x41, 0x01, 0x43, 0x01, 0x43, 0x01, 0x02, 0x41, 0x41, 0x01, 0x43, 0x80, 0x43, 0x42, 0x02, 0x41
+};
+
+int Z80::decode_block_op(uint32_t addr, block_op_t *op, bool *end)
+{
+	uint8_t *mem = mem_rbank[(addr >> 11) & 0x1f];
+	uint32_t offset = addr & 0x7ff;
+	uint8_t code = mem[offset];
+	uint8_t info = block_op_info[code];
+	int length = info & 7;
+	
+	if(info & BLOCK_STOP) {
+		// EI: the next opecode should be run by run_one_opecode
+		return 0;
+	}
+	if(code == 0xdd || code == 0xfd) {
+		// DD/FD prefix may be followed by EI or the other prefix
+		if(offset + 1 >= 0x800) {
+			return 0;
+		}
+		uint8_t next = mem[offset + 1];
+		if(next == 0xdd || next == 0xfd || next == 0xfb) {
+			return 0;
+		}
+		block_code_map[((addr + 1) >> 3) & 0x1fff] |= 1 << ((addr + 1) & 7);
+	} else if(code == 0xed && offset + 1 < 0x800) {
+		// LD (w),rr and LD rr,(w)
+		length = ((mem[offset + 1] & 0xc7) == 0x43) ? 4 : 2;
+	}
+	*end = ((info & BLOCK_END) != 0);
+	
+	op->handler = BLOCK_OP_GENERIC;
+	op->code = code;
+	op->pc = addr;
+	
+	if(offset + length <= 0x800) {
+		// register-only opecodes are run by their own handlers with the pre-decoded operands
+		int x = (code >> 3) & 7, y = code & 7;
+		if(code == 0x00) {
+			op->handler = BLOCK_OP_NOP;
+		} else if(code == 0xeb) {
+			op->handler = BLOCK_OP_EX_DE_HL;
+		} else if(code >= 0x40 && code < 0x80) {
+			if(x != 6 && y != 6) {
+				op->handler = BLOCK_OP_LD_R_R;
+			}
+		} else if(code >= 0x80 && code < 0xc0) {
+			if(y != 6) {
+				op->handler = BLOCK_OP_ALU_R + x;
+			}
+		} else if(code >= 0xc0) {
+			if(y == 6) {
+				op->handler = BLOCK_OP_ALU_N + x;
+				y = mem[offset + 1];
+			}
+		} else if(y == 1 && !(x & 1)) {
+			op->handler = BLOCK_OP_LD_RR_NN;
+			op->nn = mem[offset + 1] | (mem[offset + 2] << 8);
+		} else if(y == 3) {
+			op->handler = (x & 1) ? BLOCK_OP_DEC_RR : BLOCK_OP_INC_RR;
+		} else if(x != 6 && (y == 4 || y == 5)) {
+			op->handler = (y == 4) ? BLOCK_OP_INC_R : BLOCK_OP_DEC_R;
+		} else if(x != 6 && y == 6) {
+			op->handler = BLOCK_OP_LD_R_N;
+			y = mem[offset + 1];
+		}
+		op->x = x;
+		op->y = y;
+	}
+	if(op->handler == BLOCK_OP_GENERIC) {
+		// the operands are fetched from memory when the opecode is run
+		block_code_map[(addr >> 3) & 0x1fff] |= 1 << (addr & 7);
+	} else {
+		for(int i = 0; i < length; i++) {
+			block_code_map[((addr + i) >> 3) & 0x1fff] |= 1 << ((addr + i) & 7);
+		}
+	}
+	return length;
 }
 
+Z80::block_t* Z80::get_block()
+{
+	if(!IS_FAST_PAGE(PC)) {
+		return NULL;
+	}
+	int page = (PC >> 11) & 0x1f;
+	block_t *block = &blocks[PC & (Z80_BLOCK_CACHE_SIZE - 1)];
+	
+	if(block->pc != PC || block->page != mem_rbank[page] || block->gen != block_gen[page]) {
+		// decode the straight-line opecodes in this page
+		block->pc = PC;
+		block->page = mem_rbank[page];
+		block->gen = block_gen[page];
+		block->count = 0;
+		
+		uint32_t addr = PC;
+		while(block->count < Z80_BLOCK_MAX_OPS && (int)(addr >> 11) == page) {
+			bool end = false;
+			int length = decode_block_op(addr, &block->ops[block->count], &end);
+			if(length == 0) {
+				break;
+			}
+			block->count++;
+			if(end) {
+				break;
+			}
+			addr += length;
+		}
+	}
+	return (block->count != 0) ? block : NULL;
+}
+
+#define BLOCK_M1() do { \
+	PC++; \
+	R++; \
+	mc_tstates = 0; \
+	mc_index = -1; \
+	LOG_BLOCK_BUS(BLOCK_BUS_FETCH, op->pc, op->code); \
+	UPDATE_EXTRA_EVENT(1); \
+	UPDATE_EXTRA_EVENT(3); \
+	++mc_index; \
+	prevpc = PC - 1; \
+	icount -= cc_op[op->code]; \
+	mc_tstates = mc_op + op->code; \
+} while(0)
+
+#define BLOCK_FETCH8() do { \
+	ADD_HEAT(HEAT_READ, PC, mem_rbank[(PC >> 11) & 0x1f][PC & 0x7ff]); \
+	LOG_BLOCK_BUS(BLOCK_BUS_READ, PC, mem_rbank[(PC >> 11) & 0x1f][PC & 0x7ff]); \
+	PC++; \
+	UPDATE_EXTRA_EVENT(1); \
+	UPDATE_EXTRA_EVENT(2); \
+	++mc_index; \
+} while(0)
+
+#if defined(__GNUC__)
+#define BLOCK_CASE(id, label) label
+#define BLOCK_NEXT() goto op_done
+#else
+#define BLOCK_CASE(id, label) case id
+#define BLOCK_NEXT() break
+#endif
+
+bool Z80::run_block()
+{
+#ifdef USE_DEBUGGER
+	if(d_debugger->now_debugging) {
+		return false;
+	}
+#endif
+	block_t *block = get_block();
+	if(block == NULL) {
+		return false;
+	}
+	block_op_t *op = block->ops;
+#if defined(__GNUC__)
+	static const void *handlers[] = {
+		&&op_generic, &&op_nop, &&op_ld_r_r, &&op_ld_r_n, &&op_inc_r, &&op_dec_r,
+		&&op_ld_rr_nn, &&op_inc_rr, &&op_dec_rr, &&op_ex_de_hl,
+		&&op_add_r, &&op_adc_r, &&op_sub_r, &&op_sbc_r, &&op_and_r, &&op_xor_r, &&op_or_r, &&op_cp_r,
+		&&op_add_n, &&op_adc_n, &&op_sub_n, &&op_sbc_n, &&op_and_n, &&op_xor_n, &&op_or_n, &&op_cp_n,
+	};
+#endif
+	
+	while(1) {
+		// run one pre-decoded opecode (same as run_one_opecode)
+		after_halt = after_ei = false;
+#if HAS_LDAIR_QUIRK
+		after_ldair = false;
+#endif
+#ifdef USE_DEBUGGER
+		d_debugger->add_cpu_trace(PC);
+#endif
+#ifdef Z80_EXEC_TRACE
+		add_exec_trace();
+#endif
+#ifdef Z80_PROFILER
+		start_profile();
+#endif
+		ADD_HEAT(HEAT_EXEC, PC, op->code);
+		first_icount = icount;
+#ifdef Z80_BLOCK_CACHE_CHECK
+		block_check_t before;
+		check_block_op(op);
+		get_block_check_state(&before);
+		block_bus_count = 0;
+		block_bus_logging = true;
+#endif
+		
+#if defined(__GNUC__)
+		goto *handlers[op->handler];
+		{
+#else
+		switch(op->handler) {
+#endif
+		BLOCK_CASE(BLOCK_OP_GENERIC, op_generic):
+			PC++;
+			R++;
+			mc_tstates = 0;
+			mc_index = -1;
+			LOG_BLOCK_BUS(BLOCK_BUS_FETCH, op->pc, op->code);
+			UPDATE_EXTRA_EVENT(1);
+			UPDATE_EXTRA_EVENT(3);
+			++mc_index;
+			OP(op->code);
+			BLOCK_NEXT();
+		BLOCK_CASE(BLOCK_OP_NOP, op_nop):
+			BLOCK_M1();
+			BLOCK_NEXT();
+		BLOCK_CASE(BLOCK_OP_LD_R_R, op_ld_r_r):
+			BLOCK_M1();
+			*block_reg8[op->x] = *block_reg8[op->y];
+			BLOCK_NEXT();
+		BLOCK_CASE(BLOCK_OP_LD_R_N, op_ld_r_n):
+			BLOCK_M1();
+			BLOCK_FETCH8();
+			*block_reg8[op->x] = op->y;
+			BLOCK_NEXT();
+		BLOCK_CASE(BLOCK_OP_INC_R, op_inc_r):
+			BLOCK_M1();
+			*block_reg8[op->x] = INC(*block_reg8[op->x]);
+			BLOCK_NEXT();
+		BLOCK_CASE(BLOCK_OP_DEC_R, op_dec_r):
+			BLOCK_M1();
+			*block_reg8[op->x] = DEC(*block_reg8[op->x]);
+			BLOCK_NEXT();
+		BLOCK_CASE(BLOCK_OP_LD_RR_NN, op_ld_rr_nn):
+			BLOCK_M1();
+			BLOCK_FETCH8();
+			BLOCK_FETCH8();
+			block_reg16[op->x >> 1]->w.l = op->nn;
+			BLOCK_NEXT();
+		BLOCK_CASE(BLOCK_OP_INC_RR, op_inc_rr):
+			BLOCK_M1();
+			block_reg16[op->x >> 1]->w.l++;
+			BLOCK_NEXT();
+		BLOCK_CASE(BLOCK_OP_DEC_RR, op_dec_rr):
+			BLOCK_M1();
+			block_reg16[op->x >> 1]->w.l--;
+			BLOCK_NEXT();
+		BLOCK_CASE(BLOCK_OP_EX_DE_HL, op_ex_de_hl):
+			BLOCK_M1();
+			EX_DE_HL();
+			BLOCK_NEXT();
+		BLOCK_CASE(BLOCK_OP_ALU_R + 0, op_add_r):
+			BLOCK_M1();
+			ADD(*block_reg8[op->y]);
+			BLOCK_NEXT();
+		BLOCK_CASE(BLOCK_OP_ALU_R + 1, op_adc_r):
+			BLOCK_M1();
+			ADC(*block_reg8[op->y]);
+			BLOCK_NEXT();
+		BLOCK_CASE(BLOCK_OP_ALU_R + 2, op_sub_r):
+			BLOCK_M1();
+			SUB(*block_reg8[op->y]);
+			BLOCK_NEXT();
+		BLOCK_CASE(BLOCK_OP_ALU_R + 3, op_sbc_r):
+			BLOCK_M1();
+			SBC(*block_reg8[op->y]);
+			BLOCK_NEXT();
+		BLOCK_CASE(BLOCK_OP_ALU_R + 4, op_and_r):
+			BLOCK_M1();
+			AND(*block_reg8[op->y]);
+			BLOCK_NEXT();
+		BLOCK_CASE(BLOCK_OP_ALU_R + 5, op_xor_r):
+			BLOCK_M1();
+			XOR(*block_reg8[op->y]);
+			BLOCK_NEXT();
+		BLOCK_CASE(BLOCK_OP_ALU_R + 6, op_or_r):
+			BLOCK_M1();
+			OR(*block_reg8[op->y]);
+			BLOCK_NEXT();
+		BLOCK_CASE(BLOCK_OP_ALU_R + 7, op_cp_r):
+			BLOCK_M1();
+			CP(*block_reg8[op->y]);
+			BLOCK_NEXT();
+		BLOCK_CASE(BLOCK_OP_ALU_N + 0, op_add_n):
+			BLOCK_M1();
+			BLOCK_FETCH8();
+			ADD(op->y);
+			BLOCK_NEXT();
+		BLOCK_CASE(BLOCK_OP_ALU_N + 1, op_adc_n):
+			BLOCK_M1();
+			BLOCK_FETCH8();
+			ADC(op->y);
+			BLOCK_NEXT();
+		BLOCK_CASE(BLOCK_OP_ALU_N + 2, op_sub_n):
+			BLOCK_M1();
+			BLOCK_FETCH8();
+			SUB(op->y);
+			BLOCK_NEXT();
+		BLOCK_CASE(BLOCK_OP_ALU_N + 3, op_sbc_n):
+			BLOCK_M1();
+			BLOCK_FETCH8();
+			SBC(op->y);
+			BLOCK_NEXT();
+		BLOCK_CASE(BLOCK_OP_ALU_N + 4, op_and_n):
+			BLOCK_M1();
+			BLOCK_FETCH8();
+			AND(op->y);
+			BLOCK_NEXT();
+		BLOCK_CASE(BLOCK_OP_ALU_N + 5, op_xor_n):
+			BLOCK_M1();
+			BLOCK_FETCH8();
+			XOR(op->y);
+			BLOCK_NEXT();
+		BLOCK_CASE(BLOCK_OP_ALU_N + 6, op_or_n):
+			BLOCK_M1();
+			BLOCK_FETCH8();
+			OR(op->y);
+			BLOCK_NEXT();
+		BLOCK_CASE(BLOCK_OP_ALU_N + 7, op_cp_n):
+			BLOCK_M1();
+			BLOCK_FETCH8();
+			CP(op->y);
+			BLOCK_NEXT();
+		}
+#if defined(__GNUC__)
+op_done:
+#endif
+#ifdef Z80_BLOCK_CACHE_CHECK
+		if(op->handler != BLOCK_OP_GENERIC) {
+			check_block_state(op, &before);
+		} else {
+			check_block_writes(block, op);
+		}
+		block_bus_logging = false;
+#endif
+#ifdef USE_DEBUGGER
+		icount -= extra_icount;
+		extra_icount = 0;
+		total_icount += first_icount - icount;
+#endif
+#ifdef Z80_PROFILER
+		add_profile(first_icount - icount);
+#endif
+#if HAS_LDAIR_QUIRK
+		if(after_ldair) {
+			F &= ~PF;	// reset parity flag after LD A,I or LD A,R
+		}
+#endif
+		check_interrupt();
+		
+		// run the next opecode while no event is fired and the current line is not finished,
+		// the event manager would do nothing before it
+		if(busreq || busreq_icount != 0 || extra_icount != 0 || -icount - extra_event_passed >= *extra_event_limit) {
+			break;
+		}
+#ifdef USE_DEBUGGER
+		if(d_debugger->now_debugging) {
+			break;
+		}
+#endif
+		if(++op == block->ops + block->count || op->pc != PC || block->page != mem_rbank[(PC >> 11) & 0x1f] || block->gen != block_gen[(PC >> 11) & 0x1f] || !IS_FAST_PAGE(PC)) {
+			if((block = get_block()) == NULL) {
+				break;
+			}
+			op = block->ops;
+		}
+	}
+	return true;
+}
+
+void Z80::invalidate_block_page(int page)
+{
+	block_gen[page]++;
+	memset(block_code_map + (page << 8), 0, 0x100);
+}
+
+void Z80::invalidate_block_cache()
+{
+	for(int i = 0; i < 32; i++) {
+		invalidate_block_page(i);
+	}
+}
+
+#ifdef Z80_BLOCK_CACHE_CHECK
+void Z80::get_block_check_state(block_check_t *state)
+{
+	memset(state, 0, sizeof(block_check_t));
+	state->icount = icount;
+	state->mc_tstates = mc_tstates;
+	state->mc_index = mc_index;
+	state->prevpc = prevpc;
+	state->pc = pc.d;
+	state->sp = sp.d;
+	state->af = af.d;
+	state->bc = bc.d;
+	state->de = de.d;
+	state->hl = hl.d;
+	state->ix = ix.d;
+	state->iy = iy.d;
+	state->wz = wz.d;
+	state->af2 = af2.d;
+	state->bc2 = bc2.d;
+	state->de2 = de2.d;
+	state->hl2 = hl2.d;
+	state->I = I;
+	state->R = R;
+	state->R2 = R2;
+	state->ea = ea;
+	state->im = im;
+	state->iff1 = iff1;
+	state->iff2 = iff2;
+	state->after_halt = after_halt;
+	state->after_ei = after_ei;
+	state->after_ldair = after_ldair;
+}
+
+void Z80::set_block_check_state(const block_check_t *state)
+{
+	icount = state->icount;
+	mc_tstates = state->mc_tstates;
+	mc_index = state->mc_index;
+	prevpc = state->prevpc;
+	pc.d = state->pc;
+	sp.d = state->sp;
+	af.d = state->af;
+	bc.d = state->bc;
+	de.d = state->de;
+	hl.d = state->hl;
+	ix.d = state->ix;
+	iy.d = state->iy;
+	wz.d = state->wz;
+	af2.d = state->af2;
+	bc2.d = state->bc2;
+	de2.d = state->de2;
+	hl2.d = state->hl2;
+	I = state->I;
+	R = state->R;
+	R2 = state->R2;
+	ea = state->ea;
+	im = state->im;
+	iff1 = state->iff1;
+	iff2 = state->iff2;
+	after_halt = state->after_halt;
+	after_ei = state->after_ei;
+	after_ldair = state->after_ldair;
+}
+
+void Z80::log_block_bus(uint8_t type, uint32_t addr, uint8_t data)
+{
+	if(block_bus_count < (int)array_length(block_bus_log)) {
+		block_bus_t *bus = &block_bus_log[block_bus_count];
+		bus->type = type;
+		bus->data = data;
+		bus->addr = (uint16_t)addr;
+		bus->mc_index = mc_index;
+	}
+	block_bus_count++;
+}
+
+bool Z80::match_block_op(block_op_t *op)
+{
+	block_op_t tmp;
+	bool end;
+	memset(&tmp, 0, sizeof(tmp));
+	return !(decode_block_op(op->pc, &tmp, &end) == 0 || tmp.handler != op->handler || tmp.code != op->code || tmp.pc != op->pc ||
+	         (op->handler != BLOCK_OP_GENERIC && (tmp.x != op->x || tmp.y != op->y || (op->handler == BLOCK_OP_LD_RR_NN && tmp.nn != op->nn))));
+}
+
+void Z80::check_block_op(block_op_t *op)
+{
+	// the pre-decoded opecode should be same as the current memory
+	if(op->pc != PC || !match_block_op(op)) {
+		force_out_debug_log(_T("Z80: pre-decoded opecode %02X at %04X differs from memory\n"), op->code, op->pc);
+		exit(1);
+	}
+}
+
+void Z80::check_block_state(block_op_t *op, const block_check_t *before)
+{
+	// run the same opecode by the interpreter again and compare the registers and the bus cycles,
+	// register-only opecodes only read their operands from the fast page, so the run can be repeated
+	block_check_t after, expected;
+	block_bus_t bus_log[array_length(block_bus_log)];
+	int bus_count = block_bus_count;
+	memcpy(bus_log, block_bus_log, sizeof(bus_log));
+	get_block_check_state(&after);
+	set_block_check_state(before);
+	block_bus_count = 0;
+	is_primary = false;	// don't call update_extra_event
+	OP(FETCHOP());
+	is_primary = true;
+	get_block_check_state(&expected);
+	set_block_check_state(&after);
+	
+	if(memcmp(&after, &expected, sizeof(block_check_t)) != 0) {
+		force_out_debug_log(_T("Z80: pre-decoded opecode %02X at %04X differs from interpreter\n"), op->code, op->pc);
+		force_out_debug_log(_T("AF=%04X BC=%04X DE=%04X HL=%04X SP=%04X PC=%04X R=%02X (block)\n"), after.af & 0xffff, after.bc & 0xffff, after.de & 0xffff, after.hl & 0xffff, after.sp & 0xffff, after.pc & 0xffff, after.R);
+		force_out_debug_log(_T("AF=%04X BC=%04X DE=%04X HL=%04X SP=%04X PC=%04X R=%02X (interpreter)\n"), expected.af & 0xffff, expected.bc & 0xffff, expected.de & 0xffff, expected.hl & 0xffff, expected.sp & 0xffff, expected.pc & 0xffff, expected.R);
+		exit(1);
+	}
+	if(bus_count != block_bus_count || memcmp(bus_log, block_bus_log, sizeof(block_bus_t) * min(bus_count, (int)array_length(block_bus_log))) != 0) {
+		force_out_debug_log(_T("Z80: bus cycles of pre-decoded opecode %02X at %04X differ from interpreter\n"), op->code, op->pc);
+		for(int i = 0; i < max(bus_count, block_bus_count) && i < (int)array_length(block_bus_log); i++) {
+			force_out_debug_log(_T("%d: %d %04X %02X (block) %d %04X %02X (interpreter)\n"), i,
+				(i < bus_count) ? bus_log[i].type : -1, bus_log[i].addr, bus_log[i].data,
+				(i < block_bus_count) ? block_bus_log[i].type : -1, block_bus_log[i].addr, block_bus_log[i].data);
+		}
+		exit(1);
+	}
+}
+
+void Z80::check_block_writes(block_t *block, block_op_t *op)
+{
+	// the generic opecodes are run by the interpreter after the cached m1 cycle, so they access
+	// the devices and memory in the same way, but their memory writes and i/o may overwrite or
+	// unmap the pre-decoded code, and the block should be invalidated then
+	int page = (block->pc >> 11) & 0x1f;
+	if(block->page != mem_rbank[page] || block->gen != block_gen[page]) {
+		return;
+	}
+	bool written = false;
+	for(int i = 0; i < block_bus_count && i < (int)array_length(block_bus_log); i++) {
+		if(block_bus_log[i].type == BLOCK_BUS_WRITE || block_bus_log[i].type == BLOCK_BUS_OUT) {
+			written = true;
+			break;
+		}
+	}
+	if(written || block_bus_count > (int)array_length(block_bus_log)) {
+		for(int i = 0; i < block->count; i++) {
+			if(!match_block_op(&block->ops[i])) {
+				force_out_debug_log(_T("Z80: pre-decoded opecode %02X at %04X is not invalidated after %04X\n"), block->ops[i].code, block->ops[i].pc, op->pc);
+				exit(1);
+			}
+		}
+	}
+}
+#endif
+#endif
+
 #ifdef USE_DEBUGGER
 void Z80::write_debug_data8(uint32_t addr, uint32_t data)
 {
 	int wait;
 	d_mem_stored->write_data8w(addr, data, &wait);
+	CHECK_BLOCK_CODE(addr);
 }
 
 uint32_t Z80::read_debug_data8(uint32_t addr)
@@ -3883,6 +4829,95 @@ bool Z80::write_debug_reg(const _TCHAR *reg, uint32_t data)
 	return true;
 }
 
+uint32_t Z80::read_debug_reg(const _TCHAR *reg)
+{
+	uint32_t data = 0;
+	get_debug_reg(reg, &data);
+	return data;
+}
+
+bool Z80::is_debug_reg(const _TCHAR *reg)
+{
+	uint32_t data;
+	return get_debug_reg(reg, &data);
+}
+
+bool Z80::get_debug_reg(const _TCHAR *reg, uint32_t *data)
+{
+	if(_tcsicmp(reg, _T("PC")) == 0) {
+		*data = PC;
+	} else if(_tcsicmp(reg, _T("SP")) == 0) {
+		*data = SP;
+	} else if(_tcsicmp(reg, _T("AF")) == 0) {
+		*data = AF;
+	} else if(_tcsicmp(reg, _T("BC")) == 0) {
+		*data = BC;
+	} else if(_tcsicmp(reg, _T("DE")) == 0) {
+		*data = DE;
+	} else if(_tcsicmp(reg, _T("HL")) == 0) {
+		*data = HL;
+	} else if(_tcsicmp(reg, _T("IX")) == 0) {
+		*data = IX;
+	} else if(_tcsicmp(reg, _T("IY")) == 0) {
+		*data = IY;
+	} else if(_tcsicmp(reg, _T("A")) == 0) {
+		*data = A;
+	} else if(_tcsicmp(reg, _T("F")) == 0) {
+		*data = F;
+	} else if(_tcsicmp(reg, _T("B")) == 0) {
+		*data = B;
+	} else if(_tcsicmp(reg, _T("C")) == 0) {
+		*data = C;
+	} else if(_tcsicmp(reg, _T("D")) == 0) {
+		*data = D;
+	} else if(_tcsicmp(reg, _T("E")) == 0) {
+		*data = E;
+	} else if(_tcsicmp(reg, _T("H")) == 0) {
+		*data = H;
+	} else if(_tcsicmp(reg, _T("L")) == 0) {
+		*data = L;
+	} else if(_tcsicmp(reg, _T("HX")) == 0 || _tcsicmp(reg, _T("XH")) == 0 || _tcsicmp(reg, _T("IXH")) == 0) {
+		*data = HX;
+	} else if(_tcsicmp(reg, _T("LX")) == 0 || _tcsicmp(reg, _T("XL")) == 0 || _tcsicmp(reg, _T("IXL")) == 0) {
+		*data = LX;
+	} else if(_tcsicmp(reg, _T("HY")) == 0 || _tcsicmp(reg, _T("YH")) == 0 || _tcsicmp(reg, _T("IYH")) == 0) {
+		*data = HY;
+	} else if(_tcsicmp(reg, _T("LY")) == 0 || _tcsicmp(reg, _T("YL")) == 0 || _tcsicmp(reg, _T("IYL")) == 0) {
+		*data = LY;
+	} else if(_tcsicmp(reg, _T("I")) == 0) {
+		*data = I;
+	} else if(_tcsicmp(reg, _T("R")) == 0) {
+		*data = R;
+	} else if(_tcsicmp(reg, _T("AF'")) == 0) {
+		*data = AF2;
+	} else if(_tcsicmp(reg, _T("BC'")) == 0) {
+		*data = BC2;
+	} else if(_tcsicmp(reg, _T("DE'")) == 0) {
+		*data = DE2;
+	} else if(_tcsicmp(reg, _T("HL'")) == 0) {
+		*data = HL2;
+	} else if(_tcsicmp(reg, _T("A'")) == 0) {
+		*data = A2;
+	} else if(_tcsicmp(reg, _T("F'")) == 0) {
+		*data = F2;
+	} else if(_tcsicmp(reg, _T("B'")) == 0) {
+		*data = B2;
+	} else if(_tcsicmp(reg, _T("C'")) == 0) {
+		*data = C2;
+	} else if(_tcsicmp(reg, _T("D'")) == 0) {
+		*data = D2;
+	} else if(_tcsicmp(reg, _T("E'")) == 0) {
+		*data = E2;
+	} else if(_tcsicmp(reg, _T("H'")) == 0) {
+		*data = H2;
+	} else if(_tcsicmp(reg, _T("L'")) == 0) {
+		*data = L2;
+	} else {
+		return false;
+	}
+	return true;
+}
+
 bool Z80::get_debug_regs_info(_TCHAR *buffer, size_t buffer_len)
 {
 /*
@@ -3927,13 +4962,412 @@ int z80_dasm_ptr;
 
 int Z80::debug_dasm(uint32_t pc, _TCHAR *buffer, size_t buffer_len)
 {
+	uint8_t ops[4];
 	for(int i = 0; i < 4; i++) {
 		int wait;
-		z80_dasm_ops[i] = d_mem_stored->read_data8w(pc + i, &wait);
+		ops[i] = d_mem_stored->read_data8w(pc + i, &wait);
 	}
+	return debug_dasm_ops(pc, ops, buffer, buffer_len);
+}
+
+int Z80::debug_dasm_ops(uint32_t pc, const uint8_t *ops, _TCHAR *buffer, size_t buffer_len)
+{
+	memcpy(z80_dasm_ops, ops, sizeof(z80_dasm_ops));
 	return dasm(pc, buffer, buffer_len, d_debugger->first_symbol);
 }
 
+#ifdef Z80_EXEC_TRACE
+bool Z80::save_debug_trace(const _TCHAR *file_path)
+{
+	FILEIO* fio = new FILEIO();
+	bool result = false;
+	
+	if(fio->Fopen(file_path, FILEIO_WRITE_BINARY)) {
+		z80_exec_trace_header_t header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.id, "Z80TRACE", 8);
+		header.version = Z80_EXEC_TRACE_VERSION;
+		header.entry_size = sizeof(z80_exec_trace_t);
+		header.count = (exec_trace_ptr < Z80_EXEC_TRACE_SIZE) ? exec_trace_ptr : Z80_EXEC_TRACE_SIZE;
+		header.total = exec_trace_ptr;
+		fio->Fwrite(&header, sizeof(header), 1);
+		
+		// write the entries from the oldest one
+		uint32_t count = (uint32_t)header.count;
+		uint32_t index = (uint32_t)((exec_trace_ptr - count) & (Z80_EXEC_TRACE_SIZE - 1));
+		uint32_t first = min((int)count, (int)(Z80_EXEC_TRACE_SIZE - index));
+		fio->Fwrite(&exec_trace[index], sizeof(z80_exec_trace_t), first);
+		fio->Fwrite(&exec_trace[0], sizeof(z80_exec_trace_t), count - first);
+		fio->Fclose();
+		result = true;
+	}
+	delete fio;
+	return result;
+}
+
+bool Z80::decode_debug_trace(const _TCHAR *trace_path, const _TCHAR *text_path)
+{
+	FILEIO* fio_i = new FILEIO();
+	FILEIO* fio_o = new FILEIO();
+	bool result = false;
+	
+	if(fio_i->Fopen(trace_path, FILEIO_READ_BINARY)) {
+		z80_exec_trace_header_t header;
+		if(fio_i->Fread(&header, sizeof(header), 1) == 1 && memcmp(header.id, "Z80TRACE", 8) == 0 &&
+		   header.version == Z80_EXEC_TRACE_VERSION && header.entry_size == sizeof(z80_exec_trace_t)) {
+			if(fio_o->Fopen(text_path, FILEIO_WRITE_ASCII)) {
+				z80_exec_trace_t trace;
+				_TCHAR buffer[1024];
+				while(fio_i->Fread(&trace, sizeof(trace), 1) == 1) {
+					int len = debug_dasm_ops(trace.pc, trace.ops, buffer, array_length(buffer));
+					fio_o->Fprintf("%12llu  %04X  ", (unsigned long long)trace.clock, trace.pc);
+					for(int i = 0; i < 4; i++) {
+						if(i < len) {
+							fio_o->Fprintf("%02X", trace.ops[i]);
+						} else {
+							fio_o->Fprintf("  ");
+						}
+					}
+					fio_o->Fprintf("  %-24s  AF=%04X BC=%04X DE=%04X HL=%04X IX=%04X IY=%04X SP=%04X\n",
+						tchar_to_char(buffer), trace.af, trace.bc, trace.de, trace.hl, trace.ix, trace.iy, trace.sp);
+				}
+				fio_o->Fclose();
+				result = true;
+			}
+		}
+		fio_i->Fclose();
+	}
+	delete fio_i;
+	delete fio_o;
+	return result;
+}
+#endif
+
+#ifdef Z80_PROFILER
+void Z80::clear_debug_profile()
+{
+	// the call stack is restarted from the root node
+	memset(&prof_nodes[0], 0, sizeof(z80_profile_node_t));
+	prof_nodes[0].parent = prof_nodes[0].child = prof_nodes[0].sibling = -1;
+	prof_node_count = 1;
+	prof_node = prof_op_node = prof_depth = 0;
+	memset(prof_clocks, 0, sizeof(uint64_t) * 0x10000);
+}
+
+typedef struct {
+	uint32_t addr;
+	uint32_t callee;
+	uint64_t clocks, total, wait, calls;
+} z80_profile_entry_t;
+
+static int compare_profile_clocks(const void *a, const void *b)
+{
+	uint64_t clocks_a = ((const z80_profile_entry_t *)a)->clocks;
+	uint64_t clocks_b = ((const z80_profile_entry_t *)b)->clocks;
+	return (clocks_a < clocks_b) ? 1 : (clocks_a > clocks_b) ? -1 : 0;
+}
+
+static int compare_profile_total(const void *a, const void *b)
+{
+	uint64_t total_a = ((const z80_profile_entry_t *)a)->total;
+	uint64_t total_b = ((const z80_profile_entry_t *)b)->total;
+	return (total_a < total_b) ? 1 : (total_a > total_b) ? -1 : 0;
+}
+
+static int compare_profile_edge(const void *a, const void *b)
+{
+	const z80_profile_entry_t *edge_a = (const z80_profile_entry_t *)a;
+	const z80_profile_entry_t *edge_b = (const z80_profile_entry_t *)b;
+	if(edge_a->addr != edge_b->addr) {
+		return (edge_a->addr < edge_b->addr) ? -1 : 1;
+	}
+	return (edge_a->callee < edge_b->callee) ? -1 : (edge_a->callee > edge_b->callee) ? 1 : 0;
+}
+
+static const char *get_profile_name(symbol_t *first_symbol, uint32_t addr)
+{
+	// 0x10000 is the root node
+	if(addr > 0xffff) {
+		return "(root)";
+	}
+	return tchar_to_char(get_value_or_symbol(first_symbol, _T("%04X"), addr));
+}
+
+static double get_profile_percent(uint64_t value, uint64_t total)
+{
+	return total ? 100.0 * value / total : 0.0;
+}
+
+bool Z80::save_debug_profile(const _TCHAR *report_path, const _TCHAR *stack_path)
+{
+	symbol_t *first_symbol = d_debugger->first_symbol;
+	int count = prof_node_count;
+	
+	// clocks including the called functions
+	uint64_t *total = new uint64_t[count];
+	for(int i = 0; i < count; i++) {
+		total[i] = prof_nodes[i].clocks;
+	}
+	for(int i = count - 1; i > 0; i--) {
+		total[prof_nodes[i].parent] += total[i];
+	}
+	uint64_t all_clocks = total[0];
+	uint64_t all_wait = 0;
+	for(int i = 0; i < count; i++) {
+		all_wait += prof_nodes[i].wait;
+	}
+	
+	FILEIO* fio = new FILEIO();
+	bool result = true;
+	
+	if(report_path != NULL && !fio->Fopen(report_path, FILEIO_WRITE_ASCII)) {
+		result = false;
+	} else if(report_path != NULL) {
+		fio->Fprintf("Z80 profile: %llu clocks, %llu vram wait clocks\n", all_clocks, all_wait);
+		
+		// functions (entry addresses of CALL/RST/interrupt)
+		z80_profile_entry_t *funcs = new z80_profile_entry_t[0x10001];
+		memset(funcs, 0, sizeof(z80_profile_entry_t) * 0x10001);
+		for(int i = 0; i < count; i++) {
+			uint32_t addr = (i == 0) ? 0x10000 : prof_nodes[i].addr;
+			funcs[addr].addr = addr;
+			funcs[addr].clocks += prof_nodes[i].clocks;
+			funcs[addr].wait += prof_nodes[i].wait;
+			funcs[addr].calls += prof_nodes[i].calls;
+			// don't count the recursive call twice
+			bool recursive = false;
+			for(int node = prof_nodes[i].parent; node > 0; node = prof_nodes[node].parent) {
+				if(prof_nodes[node].addr == addr) {
+					recursive = true;
+					break;
+				}
+			}
+			if(!recursive) {
+				funcs[addr].total += total[i];
+			}
+		}
+		int func_count = 0;
+		for(int i = 0; i <= 0x10000; i++) {
+			if(funcs[i].total != 0 || funcs[i].calls != 0) {
+				funcs[func_count++] = funcs[i];
+			}
+		}
+		qsort(funcs, func_count, sizeof(z80_profile_entry_t), compare_profile_clocks);
+		fio->Fprintf("\n[functions]\n");
+		fio->Fprintf("         self clocks               total clocks        calls      vram wait  function\n");
+		for(int i = 0; i < func_count; i++) {
+			fio->Fprintf("%14llu %6.2f%%  %14llu %6.2f%%  %10llu  %13llu  ",
+				funcs[i].clocks, get_profile_percent(funcs[i].clocks, all_clocks),
+				funcs[i].total, get_profile_percent(funcs[i].total, all_clocks),
+				funcs[i].calls, funcs[i].wait);
+			fio->Fprintf("%s\n", get_profile_name(first_symbol, funcs[i].addr));
+		}
+		
+		// address ranges of symbols, or 256 bytes without symbols
+		symbol_t **owner = new symbol_t*[0x10000];
+		memset(owner, 0, sizeof(symbol_t*) * 0x10000);
+		for(symbol_t *symbol = first_symbol; symbol; symbol = symbol->next_symbol) {
+			if(owner[symbol->addr & 0xffff] == NULL) {
+				owner[symbol->addr & 0xffff] = symbol;
+			}
+		}
+		for(int i = 1; i < 0x10000; i++) {
+			if(owner[i] == NULL) {
+				owner[i] = owner[i - 1];
+			}
+		}
+		memset(funcs, 0, sizeof(z80_profile_entry_t) * 0x10001);
+		for(int i = 0; i < 0x10000; i++) {
+			uint32_t addr = (first_symbol == NULL) ? (i & 0xff00) : (owner[i] == NULL) ? 0x10000 : (owner[i]->addr & 0xffff);
+			funcs[addr].addr = addr;
+			funcs[addr].clocks += prof_clocks[i];
+		}
+		int range_count = 0;
+		for(int i = 0; i <= 0x10000; i++) {
+			if(funcs[i].clocks != 0) {
+				funcs[range_count++] = funcs[i];
+			}
+		}
+		qsort(funcs, range_count, sizeof(z80_profile_entry_t), compare_profile_clocks);
+		fio->Fprintf("\n[%s]\n", (first_symbol == NULL) ? "address ranges" : "symbols");
+		fio->Fprintf("              clocks  address\n");
+		for(int i = 0; i < range_count; i++) {
+			fio->Fprintf("%14llu %6.2f%%  ", funcs[i].clocks, get_profile_percent(funcs[i].clocks, all_clocks));
+			if(first_symbol == NULL) {
+				fio->Fprintf("%04X-%04X\n", funcs[i].addr, funcs[i].addr + 0xff);
+			} else if(funcs[i].addr > 0xffff) {
+				fio->Fprintf("(no symbol)\n");
+			} else {
+				fio->Fprintf("%s\n", tchar_to_char(owner[funcs[i].addr]->name));
+			}
+		}
+		delete[] owner;
+		delete[] funcs;
+		
+		// call graph edges
+		z80_profile_entry_t *edges = new z80_profile_entry_t[count];
+		memset(edges, 0, sizeof(z80_profile_entry_t) * count);
+		for(int i = 1; i < count; i++) {
+			edges[i - 1].addr = (prof_nodes[i].parent == 0) ? 0x10000 : prof_nodes[prof_nodes[i].parent].addr;
+			edges[i - 1].callee = prof_nodes[i].addr;
+			edges[i - 1].calls = prof_nodes[i].calls;
+			edges[i - 1].total = total[i];
+		}
+		qsort(edges, count - 1, sizeof(z80_profile_entry_t), compare_profile_edge);
+		int edge_count = 0;
+		for(int i = 0; i < count - 1; i++) {
+			if(edge_count > 0 && compare_profile_edge(&edges[edge_count - 1], &edges[i]) == 0) {
+				edges[edge_count - 1].calls += edges[i].calls;
+				edges[edge_count - 1].total += edges[i].total;
+			} else {
+				edges[edge_count++] = edges[i];
+			}
+		}
+		qsort(edges, edge_count, sizeof(z80_profile_entry_t), compare_profile_total);
+		fio->Fprintf("\n[call graph]\n");
+		fio->Fprintf("       calls    total clocks  caller -> callee\n");
+		for(int i = 0; i < edge_count; i++) {
+			fio->Fprintf("%12llu  %14llu  ", edges[i].calls, edges[i].total);
+			fio->Fprintf("%s -> ", get_profile_name(first_symbol, edges[i].addr));
+			fio->Fprintf("%s\n", get_profile_name(first_symbol, edges[i].callee));
+		}
+		delete[] edges;
+		fio->Fclose();
+	}
+	if(stack_path != NULL && !fio->Fopen(stack_path, FILEIO_WRITE_ASCII)) {
+		result = false;
+	} else if(stack_path != NULL) {
+		// collapsed stacks for flamegraph tools (ex. "(root);0000;00AD 1234")
+		int path[Z80_PROFILER_MAX_DEPTH + 1];
+		for(int i = 0; i < count; i++) {
+			if(prof_nodes[i].clocks == 0) {
+				continue;
+			}
+			int depth = 0;
+			for(int node = i; node != -1 && depth <= Z80_PROFILER_MAX_DEPTH; node = prof_nodes[node].parent) {
+				path[depth++] = node;
+			}
+			for(int j = depth - 1; j >= 0; j--) {
+				fio->Fprintf((j == depth - 1) ? "%s" : ";%s", get_profile_name(first_symbol, (path[j] == 0) ? 0x10000 : prof_nodes[path[j]].addr));
+			}
+			fio->Fprintf(" %llu\n", prof_nodes[i].clocks - prof_nodes[i].wait);
+			if(prof_nodes[i].wait != 0) {
+				for(int j = depth - 1; j >= 0; j--) {
+					fio->Fprintf((j == depth - 1) ? "%s" : ";%s", get_profile_name(first_symbol, (path[j] == 0) ? 0x10000 : prof_nodes[path[j]].addr));
+				}
+				fio->Fprintf(";(vram wait) %llu\n", prof_nodes[i].wait);
+			}
+		}
+		fio->Fclose();
+	}
+	delete fio;
+	delete[] total;
+	return result;
+}
+#endif
+
+#ifdef Z80_MEMORY_HEATMAP
+void Z80::hit_watch(int type, uint32_t addr, uint8_t data)
+{
+	static const _TCHAR *names[3] = {_T("RD"), _T("WR"), _T("EX")};
+	
+	watch_hits++;
+	OUT_TRACE_LOG(TRACE_WATCH, _T("%s %04X %02X at PC=%04X\n"), names[type], addr & 0xffff, data, prevpc);
+}
+
+void Z80::clear_debug_heatmap()
+{
+	memset(heat_count[0], 0, sizeof(uint32_t) * 0x10000 * 3);
+	watch_hits = 0;
+}
+
+bool Z80::save_debug_heatmap(const _TCHAR *image_path, const _TCHAR *report_path)
+{
+	FILEIO* fio = new FILEIO();
+	bool result = true;
+	
+	if(image_path != NULL && !fio->Fopen(image_path, FILEIO_WRITE_BINARY)) {
+		result = false;
+	} else if(image_path != NULL) {
+		// 256x256 pixels of 24bit bmp, the address is (y << 8) | x from the top left,
+		// and the writes, reads and fetches are drawn in red, green and blue with log scale
+		double scale[3];
+		for(int type = 0; type < 3; type++) {
+			uint32_t max_count = 0;
+			for(int i = 0; i < 0x10000; i++) {
+				max_count = max(max_count, heat_count[type][i]);
+			}
+			scale[type] = max_count ? 255.0 / log(1.0 + max_count) : 0.0;
+		}
+		fio->FputUint8('B');
+		fio->FputUint8('M');
+		fio->FputUint32_LE(14 + 40 + 256 * 256 * 3);	// bfSize
+		fio->FputUint32_LE(0);				// bfReserved1,2
+		fio->FputUint32_LE(14 + 40);			// bfOffBits
+		fio->FputUint32_LE(40);				// biSize
+		fio->FputInt32_LE(256);				// biWidth
+		fio->FputInt32_LE(256);				// biHeight
+		fio->FputUint16_LE(1);				// biPlanes
+		fio->FputUint16_LE(24);				// biBitCount
+		fio->FputUint32_LE(0);				// biCompression
+		fio->FputUint32_LE(256 * 256 * 3);		// biSizeImage
+		fio->FputUint32_LE(0);				// biXPelsPerMeter
+		fio->FputUint32_LE(0);				// biYPelsPerMeter
+		fio->FputUint32_LE(0);				// biClrUsed
+		fio->FputUint32_LE(0);				// biClrImportant
+		
+		uint8_t line[256 * 3];
+		for(int y = 255; y >= 0; y--) {
+			for(int x = 0; x < 256; x++) {
+				int addr = (y << 8) | x;
+				line[x * 3 + 0] = (uint8_t)(log(1.0 + heat_count[HEAT_EXEC][addr]) * scale[HEAT_EXEC] + 0.5);
+				line[x * 3 + 1] = (uint8_t)(log(1.0 + heat_count[HEAT_READ][addr]) * scale[HEAT_READ] + 0.5);
+				line[x * 3 + 2] = (uint8_t)(log(1.0 + heat_count[HEAT_WRITE][addr]) * scale[HEAT_WRITE] + 0.5);
+			}
+			fio->Fwrite(line, sizeof(line), 1);
+		}
+		fio->Fclose();
+	}
+	if(report_path != NULL && !fio->Fopen(report_path, FILEIO_WRITE_ASCII)) {
+		result = false;
+	} else if(report_path != NULL) {
+		uint64_t page_count[32][3], total[3];
+		memset(page_count, 0, sizeof(page_count));
+		memset(total, 0, sizeof(total));
+		for(int type = 0; type < 3; type++) {
+			for(int i = 0; i < 0x10000; i++) {
+				page_count[i >> 11][type] += heat_count[type][i];
+			}
+			for(int i = 0; i < 32; i++) {
+				total[type] += page_count[i][type];
+			}
+		}
+		fio->Fprintf("Z80 memory access: %llu reads, %llu writes, %llu fetches, %llu watch hits\n",
+			total[HEAT_READ], total[HEAT_WRITE], total[HEAT_EXEC], watch_hits);
+		
+		// same granularity as the memory page table
+		fio->Fprintf("\n[pages]\n");
+		fio->Fprintf("page  address             reads          writes         fetches\n");
+		for(int i = 0; i < 32; i++) {
+			fio->Fprintf("  %02X  %04X-%04X  %14llu  %14llu  %14llu\n", i, i << 11, (i << 11) | 0x7ff,
+				page_count[i][HEAT_READ], page_count[i][HEAT_WRITE], page_count[i][HEAT_EXEC]);
+		}
+		
+		fio->Fprintf("\n[watch]\n");
+		fio->Fprintf("address       reads      writes     fetches\n");
+		for(int i = 0; i < 0x10000; i++) {
+			if(watch_map[i >> 3] & (1 << (i & 7))) {
+				fio->Fprintf("   %04X  %10u  %10u  %10u\n", i,
+					heat_count[HEAT_READ][i], heat_count[HEAT_WRITE][i], heat_count[HEAT_EXEC][i]);
+			}
+		}
+		fio->Fclose();
+	}
+	delete fio;
+	return result;
+}
+#endif
+
 inline uint8_t dasm_fetchop()
 {
 	return z80_dasm_ops[z80_dasm_ptr++];
@@ -5365,6 +6799,11 @@ bool Z80::process_state(FILEIO* state_fio, bool loading)
 	if(loading) {
 		prev_total_icount = total_icount;
 	}
+#endif
+#ifdef Z80_BLOCK_CACHE
+	if(loading) {
+		invalidate_block_cache();
+	}
 #endif
 	return true;
 }
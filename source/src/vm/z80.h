@@ -26,6 +26,65 @@
 class DEBUGGER;
 #endif
 
+#ifdef Z80_BLOCK_CACHE
+#define Z80_BLOCK_CACHE_SIZE	4096
+#define Z80_BLOCK_MAX_OPS	16
+// memory is rewritten without cpu, so all pre-decoded blocks are discarded
+#define SIG_Z80_BLOCK_CACHE_FLUSH	4
+#endif
+
+#ifdef Z80_EXEC_TRACE
+#ifndef USE_DEBUGGER
+#error "Z80_EXEC_TRACE needs USE_DEBUGGER"
+#endif
+#ifndef Z80_EXEC_TRACE_SIZE
+#define Z80_EXEC_TRACE_SIZE	0x100000	// entries, must be power of 2
+#endif
+#define Z80_EXEC_TRACE_VERSION	1
+
+// the dump file has the header and the entries from the oldest one
+typedef struct {
+	char id[8];		// "Z80TRACE"
+	uint32_t version;
+	uint32_t entry_size;
+	uint64_t count;		// number of entries in this file
+	uint64_t total;		// number of entries recorded since the trace is started
+} z80_exec_trace_header_t;
+
+typedef struct {
+	uint64_t clock;		// total clocks before this opecode is run
+	uint16_t pc, af, bc, de, hl, ix, iy, sp;
+	uint8_t ops[4];
+	uint8_t reserved[4];
+} z80_exec_trace_t;
+#endif
+
+#ifdef Z80_PROFILER
+#ifndef USE_DEBUGGER
+#error "Z80_PROFILER needs USE_DEBUGGER"
+#endif
+#define Z80_PROFILER_MAX_NODES	0x10000
+#define Z80_PROFILER_MAX_DEPTH	256
+
+// node of the call tree, the root node is the code that is not called
+typedef struct {
+	uint32_t addr;		// entry address of the function
+	int parent, child, sibling;
+	uint64_t clocks;	// clocks of the opecodes in this function (including wait)
+	uint64_t wait;		// vram wait clocks in this function
+	uint64_t calls;
+} z80_profile_node_t;
+#endif
+
+#ifdef Z80_MEMORY_HEATMAP
+#ifndef USE_DEBUGGER
+#error "Z80_MEMORY_HEATMAP needs USE_DEBUGGER"
+#endif
+#define HEAT_READ	0
+#define HEAT_WRITE	1
+#define HEAT_EXEC	2
+#endif
+
 class Z80 : public DEVICE
 {
 private:
@@ -43,10 +102,122 @@ private:
 #ifdef USE_DEBUGGER
 	DEBUGGER *d_debugger;
 	DEVICE *d_mem_stored, *d_io_stored;
+#endif
+#ifdef Z80_MEMORY_PAGE_TABLE
+	// ram/rom in the page (2KB) is accessed directly if the bit of page is not set in slow pages
+	uint8_t **mem_rbank, **mem_wbank;
+	uint32_t *mem_slow_pages;
+	uint32_t mem_all_slow_pages;
+#ifdef USE_DEBUGGER
+	uint32_t *mem_slow_pages_stored;
+#endif
 #endif
 	outputs_t outputs_busack;
 	
 	bool is_primary;
+#ifdef Z80_BATCH_EXTRA_EVENT
+	// clocks are passed to update_extra_event when they exceed the limit of event manager,
+	// or before memory/io is accessed through the device
+	int extra_event_clocks;
+	int *extra_event_limit;
+#endif
+#ifdef Z80_BLOCK_CACHE
+	// opecodes in the fast pages are pre-decoded to the blocks of straight-line code,
+	// and the blocks are run continuously while no event is fired (needs Z80_MEMORY_PAGE_TABLE
+	// and Z80_BATCH_EXTRA_EVENT, and the ram page should not be mapped to multiple addresses)
+	typedef struct {
+		uint8_t handler;
+		uint8_t code;
+		uint8_t x, y;	// register index or 8bit operand
+		uint16_t nn;	// 16bit operand
+		uint16_t pc;
+	} block_op_t;
+	typedef struct {
+		uint32_t pc;
+		uint8_t *page;
+		uint32_t gen;
+		int count;
+		block_op_t ops[Z80_BLOCK_MAX_OPS];
+	} block_t;
+	block_t *blocks;
+	uint32_t block_gen[32];			// incremented when the page is invalidated
+	uint8_t block_code_map[0x10000 >> 3];	// bytes of the pre-decoded opecodes
+	uint8_t *block_reg8[8];
+	pair32_t *block_reg16[4];
+	int extra_event_passed;
+	
+	int decode_block_op(uint32_t addr, block_op_t *op, bool *end);
+	block_t* get_block();
+	bool run_block();
+	void invalidate_block_page(int page);
+	void invalidate_block_cache();
+#ifdef Z80_BLOCK_CACHE_CHECK
+	// define Z80_BLOCK_CACHE_CHECK to run the interpreter in lockstep and stop at the first difference
+	typedef struct {
+		int icount;
+		const uint8_t (*mc_tstates)[6];
+		int mc_index;
+		uint16_t prevpc;
+		uint32_t pc, sp, af, bc, de, hl, ix, iy, wz;
+		uint32_t af2, bc2, de2, hl2;
+		uint8_t I, R, R2;
+		uint32_t ea;
+		uint8_t im, iff1, iff2;
+		bool after_halt, after_ei, after_ldair;
+	} block_check_t;
+	void get_block_check_state(block_check_t *state);
+	void set_block_check_state(const block_check_t *state);
+	// bus cycles of the running opecode, to compare the memory and i/o side effects
+	typedef struct {
+		uint8_t type;
+		uint8_t data;
+		uint16_t addr;
+		int mc_index;
+	} block_bus_t;
+	block_bus_t block_bus_log[16];
+	int block_bus_count;
+	bool block_bus_logging;
+	void log_block_bus(uint8_t type, uint32_t addr, uint8_t data);
+	bool match_block_op(block_op_t *op);
+	void check_block_op(block_op_t *op);
+	void check_block_state(block_op_t *op, const block_check_t *before);
+	void check_block_writes(block_t *block, block_op_t *op);
+#endif
+#endif
+#ifdef Z80_EXEC_TRACE
+	// define Z80_EXEC_TRACE to record all opecodes with the registers into the ring buffer,
+	// and define Z80_EXEC_TRACE_TRIGGER as the condition to dump the buffer (ex. (PC == 0x0038))
+	z80_exec_trace_t *exec_trace;
+	uint64_t exec_trace_ptr;
+	inline void add_exec_trace();
+#endif
+#ifdef Z80_PROFILER
+	// define Z80_PROFILER to count the clocks per address and per call stack,
+	// the call stack is tracked with CALL/RST/interrupt and RET, and unwound with SP
+	z80_profile_node_t *prof_nodes;
+	int prof_node_count, prof_node;
+	struct {
+		int node;
+		uint16_t sp;
+	} prof_stack[Z80_PROFILER_MAX_DEPTH];
+	int prof_depth;
+	uint64_t *prof_clocks;
+	uint16_t prof_pc;
+	int prof_op_node;
+	inline void start_profile();
+	inline void add_profile(int clock);
+	void profile_call();
+	void profile_ret();
+#endif
+#ifdef Z80_MEMORY_HEATMAP
+	// define Z80_MEMORY_HEATMAP to count the reads, writes and opecode fetches per address,
+	// and to check the watched addresses with the bitmap on every access
+	uint32_t *heat_count[3];
+	uint8_t watch_map[0x10000 >> 3];
+	uint64_t watch_hits;
+	inline void add_heat(int type, uint32_t addr, uint8_t data);
+	void hit_watch(int type, uint32_t addr, uint8_t data);
+#endif
 	
 	/* ---------------------------------------------------------------------------
 	registers
@@ -112,6 +283,10 @@ private:
 	debug
 	--------------------------------------------------------------------------- */
 	
+#ifdef USE_DEBUGGER
+	bool get_debug_reg(const _TCHAR *reg, uint32_t *data);
+#endif
+	
 public:
 	Z80(VM_TEMPLATE* parent_vm, EMU* parent_emu) : DEVICE(parent_vm, parent_emu)
 	{
@@ -124,15 +299,42 @@ public:
 #endif
 #ifdef SINGLE_MODE_DMA
 		d_dma = NULL;
+#endif
+#ifdef Z80_MEMORY_PAGE_TABLE
+		mem_rbank = mem_wbank = NULL;
+		mem_all_slow_pages = 0xffffffff;
+		mem_slow_pages = &mem_all_slow_pages;
 #endif
 		initialize_output_signals(&outputs_busack);
 		is_primary = false;
+#ifdef Z80_BATCH_EXTRA_EVENT
+		extra_event_clocks = 0;
+		extra_event_limit = NULL;
+#endif
+#ifdef Z80_BLOCK_CACHE
+		blocks = NULL;
+#endif
+#ifdef Z80_EXEC_TRACE
+		exec_trace = NULL;
+		exec_trace_ptr = 0;
+#endif
+#ifdef Z80_PROFILER
+		prof_nodes = NULL;
+		prof_clocks = NULL;
+#endif
+#ifdef Z80_MEMORY_HEATMAP
+		heat_count[0] = NULL;
+		memset(watch_map, 0, sizeof(watch_map));
+#endif
 		set_device_name(_T("Z80 CPU"));
 	}
 	~Z80() {}
 	
 	// common functions
 	void initialize();
+#if defined(Z80_BLOCK_CACHE) || defined(Z80_EXEC_TRACE) || defined(Z80_PROFILER) || defined(Z80_MEMORY_HEATMAP)
+	void release();
+#endif
 	void reset();
 	int run(int clock);
 	void write_signal(int id, uint32_t data, uint32_t mask);
@@ -193,12 +395,41 @@ public:
 	void write_debug_io8(uint32_t addr, uint32_t data);
 	uint32_t read_debug_io8(uint32_t addr);
 	bool write_debug_reg(const _TCHAR *reg, uint32_t data);
+	uint32_t read_debug_reg(const _TCHAR *reg);
+	bool is_debug_reg(const _TCHAR *reg);
 	bool get_debug_regs_info(_TCHAR *buffer, size_t buffer_len);
 	int debug_dasm(uint32_t pc, _TCHAR *buffer, size_t buffer_len);
+#ifdef Z80_EXEC_TRACE
+	bool save_debug_trace(const _TCHAR *file_path);
+	bool decode_debug_trace(const _TCHAR *trace_path, const _TCHAR *text_path);
+#endif
+#ifdef Z80_PROFILER
+	void add_debug_profile_wait(int clock)
+	{
+		prof_nodes[prof_op_node].wait += clock;
+	}
+	void clear_debug_profile();
+	bool save_debug_profile(const _TCHAR *report_path, const _TCHAR *stack_path);
+#endif
+#ifdef Z80_MEMORY_HEATMAP
+	void set_debug_watch(uint32_t addr, bool value)
+	{
+		if(value) {
+			watch_map[(addr >> 3) & 0x1fff] |= 1 << (addr & 7);
+		} else {
+			watch_map[(addr >> 3) & 0x1fff] &= ~(1 << (addr & 7));
+		}
+	}
+	void clear_debug_heatmap();
+	bool save_debug_heatmap(const _TCHAR *image_path, const _TCHAR *report_path);
+#endif
 #endif
 	bool process_state(FILEIO* state_fio, bool loading);
 	
 	// unique functions
+#ifdef USE_DEBUGGER
+	int debug_dasm_ops(uint32_t pc, const uint8_t *ops, _TCHAR *buffer, size_t buffer_len);
+#endif
 	void set_context_mem(DEVICE* device)
 	{
 		d_mem = device;
@@ -207,6 +438,14 @@ public:
 	{
 		d_io = device;
 	}
+#ifdef Z80_MEMORY_PAGE_TABLE
+	void set_memory_page_table(uint8_t** rbank, uint8_t** wbank, uint32_t* slow_pages)
+	{
+		mem_rbank = rbank;
+		mem_wbank = wbank;
+		mem_slow_pages = slow_pages;
+	}
+#endif
 	void set_context_intr(DEVICE* device)
 	{
 		d_pic = device;
@@ -50,6 +50,8 @@
 //#include "../emu.h"
 #include "../common.h"
 #include "../config.h"
+#include "../sound_ring.h"
+#include "../sound_writer.h"
 
 #if defined(USE_ZLIB) && !defined(USE_VCPKG)				// zlib not installed by vcpkg
 	// relative path from *.vcproj/*.vcxproj, not from this directory :-(
@@ -427,11 +429,19 @@ private:
 	LPDIRECTSOUNDBUFFER lpdsPrimaryBuffer, lpdsSecondaryBuffer;
 	bool sound_first_half;
 	
+	// created samples are passed to the half of direct sound buffer through
+	// the ring buffer, its fill level controls the resampling ratio slightly
+	SOUND_RING sound_ring;
+	void update_sound_ring(int* extra_frames);
+	
 	_TCHAR sound_file_path[_MAX_PATH];
-	FILEIO* rec_sound_fio;
-	int rec_sound_bytes;
+	int rec_sound_id;
 	int rec_sound_buffer_ptr;
 	
+	// recorded samples are written to files by the thread, not to stall
+	// the emulation thread while the disk is busy
+	SOUND_WRITER sound_writer;
+	
 	// video device
 #if defined(USE_MOVIE_PLAYER) || defined(USE_VIDEO_CAPTURE)
 	void initialize_video();
@@ -614,6 +624,10 @@ public:
 	void stop_record_sound();
 	void restart_record_sound();
 	bool now_record_sound;
+	SOUND_WRITER* get_sound_writer()
+	{
+		return &sound_writer;
+	}
 #ifdef _UNITY	// MARU
 	int16_t	* get_sound_buffer();
 #endif // !_UNITY
@@ -8,7 +8,6 @@
 */
 
 #include "osd.h"
-#include "../fileio.h"
 
 #define DSOUND_BUFFER_SIZE (DWORD)(sound_samples * 8)
 #define DSOUND_BUFFER_HALF (DWORD)(sound_samples * 4)
@@ -20,6 +19,9 @@ void OSD::initialize_sound(int rate, int samples)
 	sound_available = sound_started = sound_muted = now_record_sound = false;
 	rec_sound_buffer_ptr = 0;
 	
+	// start the thread to write files
+	sound_writer.initialize();
+	
 	// initialize direct sound
 	PCMWAVEFORMAT pcmwf;
 	DSBUFFERDESC dsbd;
@@ -67,6 +69,12 @@ void OSD::initialize_sound(int rate, int samples)
 		return;
 	}
 	
+	// keep 3 buffers, the rate control keeps 1.5 buffers in the ring
+	// the vm writes and the direct sound reads 1 buffer at once, so the ring
+	// must hold 1 buffer just before the next write not to underrun
+	// (1 buffer underruns with 4800 samples read at once in tool/soundring)
+	sound_ring.initialize(samples * 3);
+	
 	sound_available = sound_first_half = true;
 }
 
@@ -86,8 +94,14 @@ void OSD::release_sound()
 		lpds = NULL;
 	}
 	
+	// release ring buffer
+	sound_ring.release();
+	
 	// stop recording
 	stop_record_sound();
+	
+	// close the rest of files
+	sound_writer.release();
 }
 
 void OSD::update_sound(int* extra_frames)
@@ -104,6 +118,12 @@ void OSD::update_sound(int* extra_frames)
 		DWORD play_c, write_c, offset, size1, size2;
 		WORD *ptr1, *ptr2;
 		
+		// create the sound when the vm has mixed the samples of buffer, so the
+		// extra frames are not driven to fill the buffer from here any more
+		if(vm->get_sound_buffer_ptr() >= sound_samples) {
+			update_sound_ring(extra_frames);
+		}
+		
 		// start play
 		if(!sound_started) {
 			lpdsSecondaryBuffer->Play(0, 0, DSBPLAY_LOOPING);
@@ -127,53 +147,57 @@ void OSD::update_sound(int* extra_frames)
 			offset = DSOUND_BUFFER_HALF;
 		}
 		
-		// sound buffer must be updated
-		uint16_t* sound_buffer = vm->create_sound(extra_frames);
-		if(now_record_sound) {
-			// record sound
-			if(sound_samples > rec_sound_buffer_ptr) {
-				int samples = sound_samples - rec_sound_buffer_ptr;
-				int length = samples * sizeof(uint16_t) * 2; // stereo
-				rec_sound_fio->Fwrite(sound_buffer + rec_sound_buffer_ptr * 2, length, 1);
-				rec_sound_bytes += length;
-				if(now_record_video) {
-					// sync video recording
-					static double frames = 0;
-					static int prev_samples = -1;
-					static double prev_fps = -1;
-					double fps = vm->get_frame_rate();
-					if(prev_samples != samples || prev_fps != fps) {
-						prev_samples = samples;
-						prev_fps = fps;
-						frames = fps * (double)samples / (double)sound_rate;
-					}
-					rec_video_frames -= frames;
-					if(rec_video_frames > 2) {
-						rec_video_run_frames -= (rec_video_frames - 2);
-					} else if(rec_video_frames < -2) {
-						rec_video_run_frames -= (rec_video_frames + 2);
-					}
-//					rec_video_run_frames -= rec_video_frames;
-				}
-			}
-			rec_sound_buffer_ptr = 0;
-		}
+		// the samples in the ring are copied, and the last sample is held when
+		// the ring is empty
 		if(lpdsSecondaryBuffer->Lock(offset, DSOUND_BUFFER_HALF, (void **)&ptr1, &size1, (void**)&ptr2, &size2, 0) == DSERR_BUFFERLOST) {
 			lpdsSecondaryBuffer->Restore();
 		}
-		if(sound_buffer) {
-			if(ptr1) {
-				CopyMemory(ptr1, sound_buffer, size1);
-			}
-			if(ptr2) {
-				CopyMemory(ptr2, sound_buffer + size1, size2);
-			}
+		if(ptr1) {
+			sound_ring.read_with_padding((int16_t *)ptr1, size1 / 4);
+		}
+		if(ptr2) {
+			sound_ring.read_with_padding((int16_t *)ptr2, size2 / 4);
 		}
 		lpdsSecondaryBuffer->Unlock(ptr1, size1, ptr2, size2);
 		sound_first_half = !sound_first_half;
 	}
 }
 
+void OSD::update_sound_ring(int* extra_frames)
+{
+	uint16_t* sound_buffer = vm->create_sound(extra_frames);
+	if(now_record_sound) {
+		// record sound
+		if(sound_samples > rec_sound_buffer_ptr) {
+			int samples = sound_samples - rec_sound_buffer_ptr;
+			sound_writer.write(rec_sound_id, (int16_t *)(sound_buffer + rec_sound_buffer_ptr * 2), samples);
+			if(now_record_video) {
+				// sync video recording
+				static double frames = 0;
+				static int prev_samples = -1;
+				static double prev_fps = -1;
+				double fps = vm->get_frame_rate();
+				if(prev_samples != samples || prev_fps != fps) {
+					prev_samples = samples;
+					prev_fps = fps;
+					frames = fps * (double)samples / (double)sound_rate;
+				}
+				rec_video_frames -= frames;
+				if(rec_video_frames > 2) {
+					rec_video_run_frames -= (rec_video_frames - 2);
+				} else if(rec_video_frames < -2) {
+					rec_video_run_frames -= (rec_video_frames + 2);
+				}
+//				rec_video_run_frames -= rec_video_frames;
+			}
+		}
+		rec_sound_buffer_ptr = 0;
+	}
+	if(sound_buffer) {
+		sound_ring.write_with_rate_control((int16_t *)sound_buffer, sound_samples);
+	}
+}
+
 void OSD::mute_sound()
 {
 	if(sound_available && !sound_muted) {
@@ -191,6 +215,8 @@ void OSD::mute_sound()
 			ZeroMemory(ptr2, size2);
 		}
 		lpdsSecondaryBuffer->Unlock(ptr1, size1, ptr2, size2);
+		// the ring is primed again, not to play the stale samples
+		sound_ring.clear();
 	}
 	sound_muted = true;
 }
@@ -200,6 +226,7 @@ void OSD::stop_sound()
 	if(sound_available && sound_started) {
 		lpdsSecondaryBuffer->Stop();
 		sound_started = false;
+		sound_ring.clear();
 	}
 }
 
@@ -208,22 +235,9 @@ void OSD::start_record_sound()
 	if(!now_record_sound) {
 		// create wave file
 		create_date_file_path(sound_file_path, _MAX_PATH, _T("wav"));
-		rec_sound_fio = new FILEIO();
-		if(rec_sound_fio->Fopen(sound_file_path, FILEIO_WRITE_BINARY)) {
-			// write dummy wave header
-			wav_header_t wav_header;
-			wav_chunk_t wav_chunk;
-			memset(&wav_header, 0, sizeof(wav_header));
-			memset(&wav_chunk, 0, sizeof(wav_chunk));
-			rec_sound_fio->Fwrite(&wav_header, sizeof(wav_header), 1);
-			rec_sound_fio->Fwrite(&wav_chunk, sizeof(wav_chunk), 1);
-			
-			rec_sound_bytes = 0;
+		if((rec_sound_id = sound_writer.open(sound_file_path, sound_rate, true)) != -1) {
 			rec_sound_buffer_ptr = vm->get_sound_buffer_ptr();
 			now_record_sound = true;
-		} else {
-			// failed to open the wave file
-			delete rec_sound_fio;
 		}
 	}
 }
@@ -231,35 +245,8 @@ void OSD::start_record_sound()
 void OSD::stop_record_sound()
 {
 	if(now_record_sound) {
-		if(rec_sound_bytes == 0) {
-			rec_sound_fio->Fclose();
-			FILEIO::RemoveFile(sound_file_path);
-		} else {
-			// update wave header
-			wav_header_t wav_header;
-			wav_chunk_t wav_chunk;
-			
-			memcpy(wav_header.riff_chunk.id, "RIFF", 4);
-			wav_header.riff_chunk.size = rec_sound_bytes + sizeof(wav_header) + sizeof(wav_chunk) - 8;
-			memcpy(wav_header.wave, "WAVE", 4);
-			memcpy(wav_header.fmt_chunk.id, "fmt ", 4);
-			wav_header.fmt_chunk.size = 16;
-			wav_header.format_id = 1;
-			wav_header.channels = 2;
-			wav_header.sample_bits = 16;
-			wav_header.sample_rate = sound_rate;
-			wav_header.block_size = wav_header.channels * wav_header.sample_bits / 8;
-			wav_header.data_speed = wav_header.sample_rate * wav_header.block_size;
-			
-			memcpy(wav_chunk.id, "data", 4);
-			wav_chunk.size = rec_sound_bytes;
-			
-			rec_sound_fio->Fseek(0, FILEIO_SEEK_SET);
-			rec_sound_fio->Fwrite(&wav_header, sizeof(wav_header), 1);
-			rec_sound_fio->Fwrite(&wav_chunk, sizeof(wav_chunk), 1);
-			rec_sound_fio->Fclose();
-		}
-		delete rec_sound_fio;
+		// the wave header is updated by the thread
+		sound_writer.close(rec_sound_id);
 		now_record_sound = false;
 	}
 }
@@ -354,7 +354,8 @@ int WINAPI _tWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPTSTR szCmdL
 			}
 		}
 		if(emu) {
-			// drive machine
+			// drive machine, the screen is not drawn while the frames are skipped
+			emu->set_render_demand(skip_frames == 0);
 			int run_frames = emu->run();
 			total_frames += run_frames;
 			
@@ -690,6 +691,11 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT iMsg, WPARAM wParam, LPARAM lParam)
 		case ID_FULL_SPEED:
 			config.full_speed = !config.full_speed;
 			break;
+#ifdef USE_TAPE
+		case ID_TAPE_TURBO:
+			config.tape_turbo = !config.tape_turbo;
+			break;
+#endif
 #ifdef USE_AUTO_KEY
 		case ID_AUTOKEY_START:
 			if(emu) {
@@ -879,6 +885,11 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT iMsg, WPARAM wParam, LPARAM lParam)
 			config.color_blender = !config.color_blender;
 			break;
 #endif
+#ifdef USE_ACCURATE_RASTER
+		case ID_VM_MONITOR_ACCURATE_RASTER:
+			config.accurate_raster = !config.accurate_raster;
+			break;
+#endif
 #ifdef USE_PRINTER_TYPE
 		case ID_VM_PRINTER_TYPE0: case ID_VM_PRINTER_TYPE1: case ID_VM_PRINTER_TYPE2: case ID_VM_PRINTER_TYPE3:
 		case ID_VM_PRINTER_TYPE4: case ID_VM_PRINTER_TYPE5: case ID_VM_PRINTER_TYPE6: case ID_VM_PRINTER_TYPE7:
@@ -1037,6 +1048,14 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT iMsg, WPARAM wParam, LPARAM lParam)
 				emu->update_config();
 			}
 			break;
+#ifdef USE_BAND_LIMITED_SOUND
+		case ID_SOUND_BAND_LIMITED:
+			config.sound_band_limited = !config.sound_band_limited;
+			if(emu) {
+				emu->update_config();
+			}
+			break;
+#endif
 #ifdef USE_SOUND_VOLUME
 		case ID_SOUND_VOLUME:
 			// thanks Marukun (64bit)
@@ -1521,6 +1540,9 @@ void update_control_menu(HMENU hMenu)
 		CheckMenuRadioItem(hMenu, ID_CPU_POWER0, ID_CPU_POWER4, ID_CPU_POWER0 + config.cpu_power, MF_BYCOMMAND);
 	}
 	CheckMenuItem(hMenu, ID_FULL_SPEED, config.full_speed ? MF_CHECKED : MF_UNCHECKED);
+#ifdef USE_TAPE
+	CheckMenuItem(hMenu, ID_TAPE_TURBO, config.tape_turbo ? MF_CHECKED : MF_UNCHECKED);
+#endif
 #ifdef USE_AUTO_KEY
 	bool now_paste = true, now_stop = true;
 	if(emu) {
@@ -1911,7 +1933,7 @@ void update_vm_sound_menu(HMENU hMenu)
 }
 #endif
 
-#if defined(USE_MONITOR_TYPE) || defined(USE_SCANLINE) || defined(USE_COLOR_BLENDER)
+#if defined(USE_MONITOR_TYPE) || defined(USE_SCANLINE) || defined(USE_COLOR_BLENDER) || defined(USE_ACCURATE_RASTER)
 void update_vm_monitor_menu(HMENU hMenu)
 {
 #ifdef USE_MONITOR_TYPE
@@ -1926,6 +1948,9 @@ void update_vm_monitor_menu(HMENU hMenu)
 #ifdef USE_COLOR_BLENDER
 	CheckMenuItem(hMenu, ID_VM_MONITOR_COLOR_BLENDER, config.color_blender ? MF_CHECKED : MF_UNCHECKED);
 #endif
+#ifdef USE_ACCURATE_RASTER
+	CheckMenuItem(hMenu, ID_VM_MONITOR_ACCURATE_RASTER, config.accurate_raster ? MF_CHECKED : MF_UNCHECKED);
+#endif
 }
 #endif
 
@@ -2069,6 +2094,9 @@ void update_host_sound_menu(HMENU hMenu)
 		CheckMenuRadioItem(hMenu, ID_SOUND_LATE0, ID_SOUND_LATE4, ID_SOUND_LATE0 + config.sound_latency, MF_BYCOMMAND);
 	}
 	CheckMenuRadioItem(hMenu, ID_SOUND_STRICT_RENDER, ID_SOUND_LIGHT_RENDER, config.sound_strict_rendering ? ID_SOUND_STRICT_RENDER : ID_SOUND_LIGHT_RENDER, MF_BYCOMMAND);
+#ifdef USE_BAND_LIMITED_SOUND
+	CheckMenuItem(hMenu, ID_SOUND_BAND_LIMITED, config.sound_band_limited ? MF_CHECKED : MF_UNCHECKED);
+#endif
 }
 
 void update_host_input_menu(HMENU hMenu)
@@ -2432,9 +2460,9 @@ void update_popup_menu(HWND hWnd, HMENU hMenu)
 		#endif
 	}
 #endif
-#if defined(USE_MONITOR_TYPE) || defined(USE_SCANLINE) || defined(USE_COLOR_BLENDER) || defined(USE_DIPSWITCH)
+#if defined(USE_MONITOR_TYPE) || defined(USE_SCANLINE) || defined(USE_COLOR_BLENDER) || defined(USE_ACCURATE_RASTER) || defined(USE_DIPSWITCH)
 	else if(id >= ID_VM_MONITOR_MENU_START && id <= ID_VM_MONITOR_MENU_END) {
-		#if defined(USE_MONITOR_TYPE) || defined(USE_SCANLINE) || defined(USE_COLOR_BLENDER)
+		#if defined(USE_MONITOR_TYPE) || defined(USE_SCANLINE) || defined(USE_COLOR_BLENDER) || defined(USE_ACCURATE_RASTER)
 			update_vm_monitor_menu(hMenu);
 		#endif
 		#ifdef USE_DIPSWITCH
@@ -0,0 +1,155 @@
+/*
+	Skelton for retropc emulator
+
+	Date   : 2026.10.17-
+
+	[ dot expander comparison ]
+
+	Compares DOT_EXPANDER used by MEMORY::draw_line() of MZ-700/1500 with
+	the per-dot code it replaced, which is kept here as the reference.
+
+	- text : all text patterns with all fore/back colors (pcg off)
+	- pcg  : all fore/back colors and both priorities, with all text and blue
+	  patterns and the red/green patterns that make every combination of
+	  the four planes in every dot
+	- joint : all 2^32 combinations of the text and three pcg planes in both
+	  priorities, the fore/back colors are scrambled through all 64 pairs
+
+	Build with -D_MZ1500, no other source is needed.
+
+	Usage: drawdots [-quick]
+	-quick skips the joint sweep, that takes a few minutes.
+*/
+
+#include "../../src/vm/mz700/dot_expander.h"
+
+static uint64_t compared_cells = 0;
+static uint64_t mismatched_cells = 0;
+
+// MEMORY::draw_line() before the dots were expanded with the masks
+static void draw_dots_legacy(uint8_t* dest, uint8_t pat_t, uint8_t col_f, uint8_t col_b, bool pcg_on, int priority, uint8_t pat_b, uint8_t pat_r, uint8_t pat_g)
+{
+	if(pcg_on) {
+		uint8_t pcg_dot[8];
+		pcg_dot[0] = ((pat_b & 0x80) >> 7) | ((pat_r & 0x80) >> 6) | ((pat_g & 0x80) >> 5);
+		pcg_dot[1] = ((pat_b & 0x40) >> 6) | ((pat_r & 0x40) >> 5) | ((pat_g & 0x40) >> 4);
+		pcg_dot[2] = ((pat_b & 0x20) >> 5) | ((pat_r & 0x20) >> 4) | ((pat_g & 0x20) >> 3);
+		pcg_dot[3] = ((pat_b & 0x10) >> 4) | ((pat_r & 0x10) >> 3) | ((pat_g & 0x10) >> 2);
+		pcg_dot[4] = ((pat_b & 0x08) >> 3) | ((pat_r & 0x08) >> 2) | ((pat_g & 0x08) >> 1);
+		pcg_dot[5] = ((pat_b & 0x04) >> 2) | ((pat_r & 0x04) >> 1) | ((pat_g & 0x04) >> 0);
+		pcg_dot[6] = ((pat_b & 0x02) >> 1) | ((pat_r & 0x02) >> 0) | ((pat_g & 0x02) << 1);
+		pcg_dot[7] = ((pat_b & 0x01) >> 0) | ((pat_r & 0x01) << 1) | ((pat_g & 0x01) << 2);
+
+		if(priority & 2) {
+			// pcg > text
+			dest[0] = pcg_dot[0] ? pcg_dot[0] : (pat_t & 0x80) ? col_f : col_b;
+			dest[1] = pcg_dot[1] ? pcg_dot[1] : (pat_t & 0x40) ? col_f : col_b;
+			dest[2] = pcg_dot[2] ? pcg_dot[2] : (pat_t & 0x20) ? col_f : col_b;
+			dest[3] = pcg_dot[3] ? pcg_dot[3] : (pat_t & 0x10) ? col_f : col_b;
+			dest[4] = pcg_dot[4] ? pcg_dot[4] : (pat_t & 0x08) ? col_f : col_b;
+			dest[5] = pcg_dot[5] ? pcg_dot[5] : (pat_t & 0x04) ? col_f : col_b;
+			dest[6] = pcg_dot[6] ? pcg_dot[6] : (pat_t & 0x02) ? col_f : col_b;
+			dest[7] = pcg_dot[7] ? pcg_dot[7] : (pat_t & 0x01) ? col_f : col_b;
+		} else {
+			// text_fore > pcg > text_back
+			dest[0] = (pat_t & 0x80) ? col_f : pcg_dot[0] ? pcg_dot[0] : col_b;
+			dest[1] = (pat_t & 0x40) ? col_f : pcg_dot[1] ? pcg_dot[1] : col_b;
+			dest[2] = (pat_t & 0x20) ? col_f : pcg_dot[2] ? pcg_dot[2] : col_b;
+			dest[3] = (pat_t & 0x10) ? col_f : pcg_dot[3] ? pcg_dot[3] : col_b;
+			dest[4] = (pat_t & 0x08) ? col_f : pcg_dot[4] ? pcg_dot[4] : col_b;
+			dest[5] = (pat_t & 0x04) ? col_f : pcg_dot[5] ? pcg_dot[5] : col_b;
+			dest[6] = (pat_t & 0x02) ? col_f : pcg_dot[6] ? pcg_dot[6] : col_b;
+			dest[7] = (pat_t & 0x01) ? col_f : pcg_dot[7] ? pcg_dot[7] : col_b;
+		}
+	} else {
+		// text only
+		dest[0] = (pat_t & 0x80) ? col_f : col_b;
+		dest[1] = (pat_t & 0x40) ? col_f : col_b;
+		dest[2] = (pat_t & 0x20) ? col_f : col_b;
+		dest[3] = (pat_t & 0x10) ? col_f : col_b;
+		dest[4] = (pat_t & 0x08) ? col_f : col_b;
+		dest[5] = (pat_t & 0x04) ? col_f : col_b;
+		dest[6] = (pat_t & 0x02) ? col_f : col_b;
+		dest[7] = (pat_t & 0x01) ? col_f : col_b;
+	}
+}
+
+static void compare(DOT_EXPANDER* expander, uint8_t pat_t, uint8_t col_f, uint8_t col_b, bool pcg_on, int priority, uint8_t pat_b, uint8_t pat_r, uint8_t pat_g)
+{
+	uint8_t legacy[8];
+	draw_dots_legacy(legacy, pat_t, col_f, col_b, pcg_on, priority, pat_b, pat_r, pat_g);
+
+	// same as MEMORY::expand_dots()
+	uint64_t dots = expander->expand_text(pat_t, col_f, col_b);
+	if(pcg_on) {
+		dots = expander->overlay_pcg(dots, pat_t, pat_b, pat_r, pat_g, (priority & 2) != 0);
+	}
+	if(memcmp(&dots, legacy, 8) != 0) {
+		if(mismatched_cells++ < 16) {
+			uint8_t col[8];
+			memcpy(col, &dots, 8);
+			printf("mismatch : text=%02x fore=%d back=%d pcg=%s priority=%d b=%02x r=%02x g=%02x\n", pat_t, col_f, col_b, pcg_on ? "on" : "off", priority, pat_b, pat_r, pat_g);
+			printf("  legacy : %d %d %d %d %d %d %d %d\n", legacy[0], legacy[1], legacy[2], legacy[3], legacy[4], legacy[5], legacy[6], legacy[7]);
+			printf("  masks  : %d %d %d %d %d %d %d %d\n", col[0], col[1], col[2], col[3], col[4], col[5], col[6], col[7]);
+		}
+	}
+	compared_cells++;
+}
+
+int main(int argc, char *argv[])
+{
+	bool joint = true;
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "-quick") == 0) {
+			joint = false;
+		} else {
+			printf("usage: %s [-quick]\n", argv[0]);
+			return 1;
+		}
+	}
+	DOT_EXPANDER* expander = new DOT_EXPANDER();
+
+	// text only
+	for(int col = 0; col < 64; col++) {
+		for(int pat_t = 0; pat_t < 256; pat_t++) {
+			compare(expander, pat_t, col & 7, col >> 3, false, 0, 0, 0, 0);
+		}
+	}
+	printf("text         : %llu cells\n", (unsigned long long)compared_cells);
+
+	// the first 4 red/green patterns put all their combinations on every dot,
+	// so every dot sees all 16 combinations of planes with all text/blue patterns
+	// the rest mix the red/green dots between the neighbors
+	static const uint8_t pat_rg[][2] = {
+		{0x00, 0x00}, {0xff, 0x00}, {0x00, 0xff}, {0xff, 0xff},
+		{0xaa, 0xcc}, {0x55, 0x33}, {0xcc, 0xaa}, {0x33, 0x55},
+		{0x0f, 0xf0}, {0xf0, 0x0f}, {0x3c, 0x66}, {0xc3, 0x99},
+	};
+	uint64_t prev_cells = compared_cells;
+	for(int priority = 1; priority <= 3; priority += 2) {
+		for(int col = 0; col < 64; col++) {
+			for(int i = 0; i < (int)array_length(pat_rg); i++) {
+				for(int pat = 0; pat < 0x10000; pat++) {
+					compare(expander, pat & 0xff, col & 7, col >> 3, true, priority, pat >> 8, pat_rg[i][0], pat_rg[i][1]);
+				}
+			}
+		}
+	}
+	printf("pcg          : %llu cells\n", (unsigned long long)(compared_cells - prev_cells));
+
+	if(joint) {
+		prev_cells = compared_cells;
+		for(int priority = 1; priority <= 3; priority += 2) {
+			for(uint64_t pat = 0; pat < 0x100000000ULL; pat++) {
+				int col = (int)((uint32_t)(pat * 2654435761U) >> 26);
+				compare(expander, (uint8_t)pat, col & 7, col >> 3, true, priority, (uint8_t)(pat >> 8), (uint8_t)(pat >> 16), (uint8_t)(pat >> 24));
+			}
+		}
+		printf("joint        : %llu cells\n", (unsigned long long)(compared_cells - prev_cells));
+	}
+	printf("compared     : %llu cells\n", (unsigned long long)compared_cells);
+	printf("mismatched   : %llu cells\n", (unsigned long long)mismatched_cells);
+
+	delete expander;
+	return (mismatched_cells != 0) ? 1 : 0;
+}
@@ -0,0 +1,303 @@
+/*
+	Skelton for retropc emulator
+
+	Date   : 2026.10.17-
+
+	[ event manager micro benchmark ]
+
+	Drives the event manager of MZ-1500 with dummy devices that register
+	the same events as the real machine while loading a tape image:
+	- MEMORY   : 6 one-shot events per line, TEMPO and BLINK loop events
+	- DATAREC  : loop event per 48KHz sample of the tape signal
+	- EVENT    : loop event per 48KHz sample to mix sound
+	- Z80      : 4-23 clocks per opecode
+
+	Build with -D_MZ1500 (and -DEVENT_LIST_SCHEDULER for the legacy list),
+	and link src/vm/event.cpp, src/vm/pcm1bit.cpp, src/vm/sn76489an.cpp,
+	src/sound_writer.cpp, src/common.cpp and src/fileio.cpp.
+
+	Usage: eventbench [frames] [-legacy] [-sound | -tone] [-band-limited]
+	-legacy registers the events of MEMORY in every line instead of the vline
+	timeline. The order hash must be same in all schedulers and modes.
+	-sound mixes PCM1BIT and 2 SN76489AN of MZ-1500 to 48KHz and prints the
+	host time spent in sound per emulated second, that is the difference from
+	the run without sound (the fastest of 3 runs). The devices are silent as
+	the most time of games.
+	-tone plays 3 tones and noise of PSG, and 1KHz square wave of PCM1BIT.
+	-band-limited synthesizes PSG and PCM1BIT with band-limited steps.
+*/
+
+#include <time.h>
+#include "../../src/vm/event.h"
+#include "../../src/vm/pcm1bit.h"
+#include "../../src/vm/sn76489an.h"
+
+config_t config;
+
+void EMU::out_debug_log(const _TCHAR* format, ...)
+{
+}
+
+void EMU::force_out_debug_log(const _TCHAR* format, ...)
+{
+}
+
+// fired order is hashed to compare the schedulers
+static uint64_t order_hash = 14695981039346656037ULL;
+static uint64_t fired_events = 0;
+static uint64_t inserted_events = 0;
+static bool legacy_vline = false;
+static bool band_limited = false;
+
+class BENCH_DEVICE : public DEVICE
+{
+protected:
+	void fired(int event_id)
+	{
+		uint64_t values[3] = {get_current_clock(), (uint64_t)this_device_id, (uint64_t)event_id};
+		uint8_t *p = (uint8_t *)values;
+		for(int i = 0; i < (int)sizeof(values); i++) {
+			order_hash = (order_hash ^ p[i]) * 1099511628211ULL;
+		}
+		fired_events++;
+	}
+public:
+	BENCH_DEVICE(VM_TEMPLATE* parent_vm) : DEVICE(parent_vm, NULL) {}
+	~BENCH_DEVICE() {}
+
+	void event_callback(int event_id, int err)
+	{
+		fired(event_id);
+	}
+};
+
+class BENCH_CPU : public BENCH_DEVICE
+{
+private:
+	uint32_t seed;
+public:
+	BENCH_CPU(VM_TEMPLATE* parent_vm) : BENCH_DEVICE(parent_vm)
+	{
+		seed = 1;
+	}
+	int run(int clock)
+	{
+		static const int clocks[8] = {4, 4, 7, 7, 10, 11, 13, 23};
+		seed = seed * 1103515245 + 12345;
+		return clocks[(seed >> 16) & 7];
+	}
+};
+
+class BENCH_MEMORY : public BENCH_DEVICE
+{
+public:
+	BENCH_MEMORY(VM_TEMPLATE* parent_vm) : BENCH_DEVICE(parent_vm) {}
+	void initialize()
+	{
+		register_vline_event(this);
+		if(!legacy_vline) {
+			register_vline_timeline_event(this, 4, 160);	// hblank_s
+			register_vline_timeline_event(this, 2, 160);	// blank_s
+			register_vline_timeline_event(this, 3, 220);	// blank_e
+			register_vline_timeline_event(this, 6, 180);	// hsync_s
+			register_vline_timeline_event(this, 7, 196);	// hsync_e
+			register_vline_timeline_event(this, 8, 170);	// hblank_pcg_s
+		}
+		register_event_by_clock(this, 0, CPU_CLOCKS / 64, true, NULL);	// tempo
+		register_event_by_clock(this, 1, CPU_CLOCKS / 3, true, NULL);	// blink
+	}
+	void event_vline(int v, int clock)
+	{
+		if(!legacy_vline) {
+			return;
+		}
+		register_event_by_clock(this, 4, 160, false, NULL);	// hblank_s
+		register_event_by_clock(this, 2, 160, false, NULL);	// blank_s
+		register_event_by_clock(this, 3, 220, false, NULL);	// blank_e
+		register_event_by_clock(this, 6, 180, false, NULL);	// hsync_s
+		register_event_by_clock(this, 7, 196, false, NULL);	// hsync_e
+		register_event_by_clock(this, 8, 170, false, NULL);	// hblank_pcg_s
+	}
+};
+
+class BENCH_LOOP : public BENCH_DEVICE
+{
+private:
+	double usec;
+public:
+	BENCH_LOOP(VM_TEMPLATE* parent_vm, double period) : BENCH_DEVICE(parent_vm)
+	{
+		usec = period;
+	}
+	void initialize()
+	{
+		register_event(this, 0, usec, true, NULL);
+	}
+};
+
+// square wave of PCM1BIT
+class BENCH_BEEP : public BENCH_DEVICE
+{
+private:
+	PCM1BIT *d_pcm;
+	bool signal;
+public:
+	BENCH_BEEP(VM_TEMPLATE* parent_vm, PCM1BIT *pcm) : BENCH_DEVICE(parent_vm)
+	{
+		d_pcm = pcm;
+		signal = false;
+	}
+	void initialize()
+	{
+		register_event(this, 0, 500.0, true, NULL);
+	}
+	void event_callback(int event_id, int err)
+	{
+		d_pcm->write_signal(SIG_PCM1BIT_SIGNAL, (signal = !signal) ? 1 : 0, 1);
+	}
+};
+
+#define SOUND_RATE	48000
+#define SOUND_SAMPLES	4800
+
+static double get_sec(struct timespec *start, struct timespec *end)
+{
+	return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1000000000.0;
+}
+
+static double run_vm(int frames, bool sound, bool tone, uint32_t *sound_hash)
+{
+	VM_TEMPLATE* vm = new VM_TEMPLATE(NULL);
+	vm->first_device = vm->last_device = NULL;
+
+	// the devices are released through the device chain of vm
+	new DEVICE(vm, NULL);	// dummy
+	EVENT* event = new EVENT(vm, NULL);
+	BENCH_CPU* cpu = new BENCH_CPU(vm);
+	new BENCH_MEMORY(vm);
+	new BENCH_LOOP(vm, 1000000.0 / 48000);	// datarec
+	new BENCH_LOOP(vm, 1000000.0 / 48000);	// mixer
+	PCM1BIT* pcm = NULL;
+	SN76489AN* psg_l = NULL;
+	SN76489AN* psg_r = NULL;
+	event->set_context_cpu(cpu);
+	if(sound) {
+		pcm = new PCM1BIT(vm, NULL, true);
+		psg_l = new SN76489AN(vm, NULL);
+		psg_r = new SN76489AN(vm, NULL);
+		if(tone) {
+			new BENCH_BEEP(vm, pcm);
+		}
+		event->set_context_sound(pcm);
+		event->set_context_sound(psg_l);
+		event->set_context_sound(psg_r);
+	}
+
+	for(DEVICE* device = vm->first_device; device; device = device->next_device) {
+		device->initialize();
+	}
+	if(sound) {
+		event->initialize_sound(SOUND_RATE, SOUND_SAMPLES);
+		pcm->initialize_sound(SOUND_RATE, 8000);
+		psg_l->initialize_sound(SOUND_RATE, 3579545, 8000);
+		psg_r->initialize_sound(SOUND_RATE, 3579545, 8000);
+		pcm->set_band_limited(band_limited);
+		psg_l->set_band_limited(band_limited);
+		psg_r->set_band_limited(band_limited);
+	}
+	for(DEVICE* device = vm->first_device; device; device = device->next_device) {
+		device->reset();
+	}
+	if(tone) {
+		static const uint8_t regs[] = {0x8e, 0x0f, 0x90, 0xa5, 0x08, 0xb2, 0xc0, 0x10, 0xd4, 0xe4, 0xf3};
+		for(int i = 0; i < (int)sizeof(regs); i++) {
+			psg_l->write_io8(0, regs[i]);
+			psg_r->write_io8(0, regs[i]);
+		}
+	}
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(int i = 0; i < frames; i++) {
+		event->drive();
+		if(sound && event->get_sound_buffer_ptr() >= SOUND_SAMPLES) {
+			int extra_frames = 0;
+			uint16_t* buffer = event->create_sound(&extra_frames);
+			for(int j = 0; j < SOUND_SAMPLES * 2; j++) {
+				*sound_hash = (*sound_hash ^ buffer[j]) * 16777619;
+			}
+			i += extra_frames;
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	// counted in EVENT::insert_event(), the loop events rescheduled in the heap are not inserted
+	inserted_events = event->get_total_inserted_events();
+
+	for(DEVICE* device = vm->first_device; device;) {
+		DEVICE *next_device = device->next_device;
+		device->release();
+		delete device;
+		device = next_device;
+	}
+	delete vm;
+	return get_sec(&start, &end);
+}
+
+int main(int argc, char *argv[])
+{
+	int frames = 6000;
+	bool sound = false, tone = false;
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "-legacy") == 0) {
+			legacy_vline = true;
+		} else if(strcmp(argv[i], "-sound") == 0) {
+			sound = true;
+		} else if(strcmp(argv[i], "-tone") == 0) {
+			sound = tone = true;
+		} else if(strcmp(argv[i], "-band-limited") == 0) {
+			band_limited = true;
+		} else {
+			frames = atoi(argv[i]);
+		}
+	}
+
+	if(sound) {
+		uint32_t sound_hash = 2166136261U, dummy_hash = 0;
+		double base_sec = 0, sound_sec = 0;
+		// the fastest of 3 runs to reduce the noise of the host
+		for(int i = 0; i < 3; i++) {
+			double sec = run_vm(frames, false, false, &dummy_hash);
+			if(i == 0 || sec < base_sec) {
+				base_sec = sec;
+			}
+			sound_hash = 2166136261U;
+			sec = run_vm(frames, true, tone, &sound_hash);
+			if(i == 0 || sec < sound_sec) {
+				sound_sec = sec;
+			}
+		}
+		double vm_sec = frames / FRAMES_PER_SEC;
+		printf("sound        : %s\n", tone ? "psg tones and pcm square wave" : "silent");
+		printf("synthesis    : %s\n", band_limited ? "band-limited steps" : "legacy");
+		printf("frames       : %d (%.1f sec in vm)\n", frames, vm_sec);
+		printf("elapsed      : %.3f sec (%.3f sec without sound)\n", sound_sec, base_sec);
+		printf("sound time   : %.3f msec per sec in vm\n", (sound_sec - base_sec) * 1000.0 / vm_sec);
+		printf("sound hash   : %08x\n", sound_hash);
+		return 0;
+	}
+
+	double sec = run_vm(frames, false, false, NULL);
+#ifdef EVENT_LIST_SCHEDULER
+	printf("scheduler    : linked list\n");
+#else
+	printf("scheduler    : 4-ary heap\n");
+#endif
+	printf("vline events : %s\n", legacy_vline ? "registered in every line" : "vline timeline");
+	printf("frames       : %d (%.1f sec in vm)\n", frames, frames / FRAMES_PER_SEC);
+	printf("inserted     : %llu (%.1f per frame)\n", (unsigned long long)inserted_events, (double)inserted_events / frames);
+	printf("fired        : %llu\n", (unsigned long long)fired_events);
+	printf("elapsed      : %.3f sec\n", sec);
+	printf("events/sec   : %.0f\n", fired_events / sec);
+	printf("order hash   : %016llx\n", (unsigned long long)order_hash);
+	return 0;
+}
@@ -0,0 +1,173 @@
+/*
+	Skelton for retropc emulator
+
+	Date   : 2026.10.17-
+
+	[ sound ring buffer simulator ]
+
+	Passes the sound from a producer paced by the video frames to a consumer
+	thread paced by the clock of a simulated audio device, through SOUND_RING
+	as OSD does. The clock of the device drifts from the emulated sound rate,
+	and the producer stalls sometimes as the host under load.
+
+	Build with -D_MZ1500, and link src/sound_ring.cpp, src/common.cpp and
+	src/fileio.cpp.
+
+	Usage: soundring [sec] [-drift ppm] [-speed n] [-chunk n] [-stall] [-no-control]
+	-drift is the error of the device clock (default +2000ppm = 0.2% faster).
+	-speed runs the simulated time n times faster (default 4).
+	-chunk is the samples read by the device at once (default 480 = 10msec),
+	4800 reads the half of buffer as the direct sound of win32 osd.
+	-stall stops the producer for 4 frames in every 3 seconds and catches up.
+	-no-control writes the samples without the rate control.
+*/
+
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include "../../src/sound_ring.h"
+
+#define SOUND_RATE	48000
+#define SOUND_SAMPLES	4800	// 100msec, the block created by the vm
+#define FRAMES_PER_SEC	60.0
+
+static SOUND_RING ring;
+static volatile bool running = true;
+static double drift_ppm = 2000.0;
+static double speed = 4.0;
+static int device_chunk = 480;
+
+// statistics of the consumer
+static uint64_t consumed_samples = 0;
+static int fill_min = 0x7fffffff, fill_max = 0;
+static double fill_sum = 0;
+static int fill_count = 0;
+static int underrun_times = 0;
+
+static void add_nsec(struct timespec *ts, double nsec)
+{
+	long long t = ts->tv_nsec + (long long)nsec;
+	ts->tv_sec += t / 1000000000LL;
+	ts->tv_nsec = t % 1000000000LL;
+}
+
+static void* consumer_thread(void *arg)
+{
+	int16_t buffer[SOUND_SAMPLES * 2];
+	double period = 1000000000.0 * device_chunk / (SOUND_RATE * (1.0 + drift_ppm / 1000000.0)) / speed;
+	struct timespec next;
+	clock_gettime(CLOCK_MONOTONIC, &next);
+
+	while(running) {
+		add_nsec(&next, period);
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+		int count = ring.get_count();
+		uint32_t prev_underrun = ring.get_underrun_samples();
+		ring.read_with_padding(buffer, device_chunk);
+		if(ring.get_underrun_samples() != prev_underrun) {
+			underrun_times++;
+		}
+		consumed_samples += device_chunk;
+		fill_min = min(fill_min, count);
+		fill_max = max(fill_max, count);
+		fill_sum += count;
+		fill_count++;
+	}
+	return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+	double sec = 60.0;
+	bool control = true, stall = false;
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "-drift") == 0 && i + 1 < argc) {
+			drift_ppm = atof(argv[++i]);
+		} else if(strcmp(argv[i], "-speed") == 0 && i + 1 < argc) {
+			speed = atof(argv[++i]);
+		} else if(strcmp(argv[i], "-chunk") == 0 && i + 1 < argc) {
+			device_chunk = min(max(atoi(argv[++i]), 1), SOUND_SAMPLES);
+		} else if(strcmp(argv[i], "-stall") == 0) {
+			stall = true;
+		} else if(strcmp(argv[i], "-no-control") == 0) {
+			control = false;
+		} else {
+			sec = atof(argv[i]);
+		}
+	}
+
+	// same as win32 osd
+	ring.initialize(SOUND_SAMPLES * 3);
+
+	int16_t block[SOUND_SAMPLES * 2];
+	int block_ptr = 0;
+	int frames = (int)(sec * FRAMES_PER_SEC);
+	double frame_period = 1000000000.0 / FRAMES_PER_SEC / speed;
+	double phase = 0, ratio_min = 2.0, ratio_max = 0;
+	uint64_t created_samples = 0;
+	double sample_accum = 0;
+	pthread_t consumer_id;
+	bool consumer_started = false;
+	struct timespec next;
+	clock_gettime(CLOCK_MONOTONIC, &next);
+
+	for(int frame = 0; frame < frames; frame++) {
+		if(stall && (frame % (int)(FRAMES_PER_SEC * 3)) == (int)(FRAMES_PER_SEC * 3) - 1) {
+			// the host is busy for 4 frames, and the skipped frames run at once
+			add_nsec(&next, frame_period * 4);
+			clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+			add_nsec(&next, -frame_period * 4);
+		}
+		add_nsec(&next, frame_period);
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+		// the vm mixes the samples of 1 frame (440Hz sine wave)
+		sample_accum += SOUND_RATE / FRAMES_PER_SEC;
+		int samples = (int)sample_accum;
+		sample_accum -= samples;
+		for(int i = 0; i < samples; i++) {
+			int16_t value = (int16_t)(8000 * sin(phase));
+			phase += 2 * 3.14159265358979323846 * 440 / SOUND_RATE;
+			block[block_ptr * 2 + 0] = block[block_ptr * 2 + 1] = value;
+			if(++block_ptr == SOUND_SAMPLES) {
+				// osd->update_sound() creates the sound without extra frames
+				if(control) {
+					ring.write_with_rate_control(block, SOUND_SAMPLES);
+					double ratio = ring.get_ratio();
+					if(ratio < ratio_min) {
+						ratio_min = ratio;
+					}
+					if(ratio > ratio_max) {
+						ratio_max = ratio;
+					}
+				} else {
+					ring.write(block, SOUND_SAMPLES);
+				}
+				created_samples += SOUND_SAMPLES;
+				block_ptr = 0;
+				if(!consumer_started) {
+					pthread_create(&consumer_id, NULL, consumer_thread, NULL);
+					consumer_started = true;
+				}
+			}
+		}
+	}
+	running = false;
+	if(consumer_started) {
+		pthread_join(consumer_id, NULL);
+	}
+
+	printf("rate control : %s\n", control ? "on" : "off");
+	printf("device clock : %+.0f ppm%s\n", drift_ppm, stall ? " (producer stalls)" : "");
+	printf("simulated    : %.1f sec (x%.1f)\n", sec, speed);
+	printf("created      : %llu samples\n", (unsigned long long)created_samples);
+	printf("consumed     : %llu samples\n", (unsigned long long)consumed_samples);
+	printf("underrun     : %u samples (%d times)\n", ring.get_underrun_samples(), underrun_times);
+	printf("overrun      : %u samples\n", ring.get_overrun_samples());
+	printf("fill         : %d / %.0f / %d of %d (min / avg / max)\n", fill_min, fill_count ? fill_sum / fill_count : 0.0, fill_max, ring.get_capacity());
+	if(control) {
+		printf("ratio        : %.5f - %.5f\n", ratio_min, ratio_max);
+	}
+	return 0;
+}